@@ -0,0 +1,122 @@
+#include "ggit-merge.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* NOTE(boz):
+    ggit-merge-bench [subjects] [rounds]
+
+    Runs the default merge patterns over a generated history - plain subjects,
+    merges in every format the defaults know and a few that start like a merge
+    but aren't one. Prints the best round in ns per subject.
+*/
+
+static uint32_t
+ggit_bench_next(uint32_t* state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+static int
+ggit_bench_subject(uint32_t* rng, char* out, size_t size)
+{
+    static char const* const families[] = { "feature/", "hotfix/", "release/", "bugfix/", "" };
+    static char const* const words[] = {
+        "Fix", "Add", "Remove", "Refactor", "Update", "parser", "layout", "the", "crash", "when",
+        "loading", "large", "repositories", "tests", "docs", "build",
+    };
+    char const* f = families[ggit_bench_next(rng) % 5];
+    unsigned const b = ggit_bench_next(rng) % 1000;
+    unsigned const n = ggit_bench_next(rng) % 100000;
+
+    switch (ggit_bench_next(rng) % 16) {
+        case 0:
+            return snprintf(out, size, "Merge pull request #%u from boz/%s%u", n, f, b);
+        case 1:
+            return snprintf(out, size, "Merge branch '%s%u' into 'master'", f, b);
+        case 2:
+            return snprintf(out, size, "Merge branch '%s%u' of github.com:boz/ggit into %s%u", f, b, f, n);
+        case 3:
+            return snprintf(out, size, "Merge branch '%s%u'", f, b);
+        case 4:
+            return snprintf(out, size, "Merge branches '%s%u', 'develop' and '%s%u' into master", f, b, f, n);
+        case 5:
+            return snprintf(out, size, "Merge remote-tracking branch 'origin/%s%u' into develop", f, b);
+        case 6:
+            return snprintf(out, size, "Merged in %s%u (pull request #%u)", f, b, n);
+        case 7:
+            return snprintf(out, size, "Merging is hard, %s%u explains why", f, b);
+        default:
+            break;
+    }
+    int length = 0;
+    int const n_words = 3 + (int)(ggit_bench_next(rng) % 8);
+    for (int w = 0; w < n_words && (size_t)length < size; ++w)
+        length += snprintf(out + length, size - length, w ? " %s" : "%s", words[ggit_bench_next(rng) % 16]);
+    return length;
+}
+
+int
+main(int argc, char** argv)
+{
+    int const count = argc > 1 ? atoi(argv[1]) : 4 * 1000 * 1000;
+    int const rounds = argc > 2 ? atoi(argv[2]) : 5;
+    if (count <= 0 || rounds <= 0) {
+        fprintf(stderr, "usage: %s [subjects] [rounds]\n", argv[0]);
+        return 1;
+    }
+
+    /* Back to back like the graph's message store, subjects end in a '\0'. */
+    struct ggit_vec_char store;
+    struct ggit_vec_int lengths;
+    ggit_vec_char_init(&store);
+    ggit_vec_int_init(&lengths);
+    ggit_vec_int_reserve(&lengths, (size_t)count);
+
+    uint32_t rng = 0x9E3779B9u;
+    char subject[256];
+    for (int i = 0; i < count; ++i) {
+        int const length = ggit_bench_subject(&rng, subject, sizeof(subject));
+        memcpy(ggit_vec_char_extend(&store, (size_t)length + 1), subject, (size_t)length + 1);
+        ggit_vec_int_push(&lengths, length);
+    }
+
+    struct ggit_merge_patterns patterns;
+    ggit_merge_patterns_init(&patterns);
+    ggit_merge_patterns_add_defaults(&patterns);
+
+    double best = 0.0;
+    int recognized = 0;
+    for (int r = 0; r < rounds; ++r) {
+        clock_t const start = clock();
+        char const* message = store.data;
+        recognized = 0;
+        for (int i = 0; i < count; ++i) {
+            struct ggit_merge_match match;
+            recognized += ggit_merge_match(&patterns, lengths.data[i], message, &match);
+            message += lengths.data[i] + 1;
+        }
+        double const seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+        if (r == 0 || seconds < best)
+            best = seconds;
+    }
+
+    printf(
+        "%d subjects, %d merges recognized, %.1f ns/subject (best of %d)\n",
+        count,
+        recognized,
+        1e9 * best / count,
+        rounds
+    );
+
+    ggit_merge_patterns_destroy(&patterns);
+    ggit_vec_char_destroy(&store);
+    ggit_vec_int_destroy(&lengths);
+    return 0;
+}
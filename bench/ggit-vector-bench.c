@@ -0,0 +1,65 @@
+#include "ggit-vector.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* NOTE(boz):
+    ggit-vector-bench [values] [rounds]
+
+    Pushes ints one at a time into a ggit_vector (out of line, int sizes) and
+    into a typed ggit_vec_int (inline), from empty every round. Prints the best
+    round of each in ns per push. The sum of what was pushed keeps the compiler
+    from dropping the loops.
+*/
+
+static double
+ggit_bench_seconds(clock_t start)
+{
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+int
+main(int argc, char** argv)
+{
+    int const count = argc > 1 ? atoi(argv[1]) : 50 * 1000 * 1000;
+    int const rounds = argc > 2 ? atoi(argv[2]) : 5;
+    if (count <= 0 || rounds <= 0) {
+        fprintf(stderr, "usage: %s [values] [rounds]\n", argv[0]);
+        return 1;
+    }
+
+    double best_untyped = 0.0;
+    double best_typed = 0.0;
+    int64_t sum = 0;
+    for (int r = 0; r < rounds; ++r) {
+        struct ggit_vector untyped;
+        ggit_vector_init(&untyped, sizeof(int));
+        clock_t start = clock();
+        for (int i = 0; i < count; ++i)
+            ggit_vector_push(&untyped, &i);
+        double const untyped_seconds = ggit_bench_seconds(start);
+        sum += ggit_vector_get_int(&untyped, count - 1);
+        ggit_vector_destroy(&untyped);
+
+        struct ggit_vec_int typed;
+        ggit_vec_int_init(&typed);
+        start = clock();
+        for (int i = 0; i < count; ++i)
+            ggit_vec_int_push(&typed, i);
+        double const typed_seconds = ggit_bench_seconds(start);
+        sum += typed.data[count - 1];
+        ggit_vec_int_destroy(&typed);
+
+        if (r == 0 || untyped_seconds < best_untyped)
+            best_untyped = untyped_seconds;
+        if (r == 0 || typed_seconds < best_typed)
+            best_typed = typed_seconds;
+    }
+
+    printf("%d pushes, best of %d (checksum %lld)\n", count, rounds, (long long)sum);
+    printf("  ggit_vector  %6.2f ns/push\n", 1e9 * best_untyped / count);
+    printf("  ggit_vec_int %6.2f ns/push\n", 1e9 * best_typed / count);
+    return 0;
+}
@@ -0,0 +1,185 @@
+#include "ggit-ancestry.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+/* Drops the cached sets once the graph they were computed on is gone. */
+static void
+ggit_ancestry__sync(struct ggit_ancestry* ancestry, struct ggit_graph const* graph)
+{
+    if (ancestry->revision == graph->revision)
+        return;
+    ancestry->revision = graph->revision;
+    for (int i = 0; i < GGIT_ANCESTRY_CACHE; ++i)
+        ancestry->cache[i].commit = -1;
+    ggit_bitset_resize(&ancestry->visited, graph->height);
+}
+static struct ggit_ancestry_entry*
+ggit_ancestry__find(struct ggit_ancestry* ancestry, int commit, bool descendants)
+{
+    for (int i = 0; i < GGIT_ANCESTRY_CACHE; ++i) {
+        struct ggit_ancestry_entry* entry = &ancestry->cache[i];
+        if (entry->commit == commit && entry->descendants == descendants) {
+            entry->used = ++ancestry->clock;
+            return entry;
+        }
+    }
+    return 0;
+}
+/* Takes over the least recently used entry. */
+static struct ggit_ancestry_entry*
+ggit_ancestry__evict(
+    struct ggit_ancestry* ancestry,
+    struct ggit_graph const* graph,
+    int commit,
+    bool descendants
+)
+{
+    struct ggit_ancestry_entry* entry = &ancestry->cache[0];
+    for (int i = 1; i < GGIT_ANCESTRY_CACHE; ++i) {
+        if (ancestry->cache[i].used < entry->used)
+            entry = &ancestry->cache[i];
+    }
+    entry->commit = commit;
+    entry->descendants = descendants;
+    entry->used = ++ancestry->clock;
+
+    ggit_bitset_resize(&entry->set, graph->height);
+    ggit_bitset_set(&entry->set, commit);
+    return entry;
+}
+
+void
+ggit_ancestry_init(struct ggit_ancestry* ancestry)
+{
+    memset(ancestry, 0, sizeof(*ancestry));
+    ancestry->revision = -1;
+    for (int i = 0; i < GGIT_ANCESTRY_CACHE; ++i) {
+        ancestry->cache[i].commit = -1;
+        ggit_bitset_init(&ancestry->cache[i].set);
+    }
+    ggit_bitset_init(&ancestry->visited);
+    ggit_vector_init(&ancestry->stack, sizeof(int));
+}
+void
+ggit_ancestry_destroy(struct ggit_ancestry* ancestry)
+{
+    for (int i = 0; i < GGIT_ANCESTRY_CACHE; ++i)
+        ggit_bitset_destroy(&ancestry->cache[i].set);
+    ggit_bitset_destroy(&ancestry->visited);
+    ggit_vector_destroy(&ancestry->stack);
+}
+/** The commit and everything reachable from it. O(commit) the first time, cached after. */
+struct ggit_bitset const*
+ggit_ancestry_reachable(struct ggit_ancestry* ancestry, struct ggit_graph const* graph, int commit)
+{
+    ggit_ancestry__sync(ancestry, graph);
+
+    struct ggit_ancestry_entry* entry = ggit_ancestry__find(ancestry, commit, false);
+    if (entry)
+        return &entry->set;
+
+    struct ggit_bitset* set = &ggit_ancestry__evict(ancestry, graph, commit, false)->set;
+
+    /* NOTE(boz):
+        Parents always come before their children, so one sweep downwards
+        sees every commit after all of its children.
+    */
+    for (int c = commit; c >= 0; --c) {
+        if (!ggit_bitset_test(set, c))
+            continue;
+        int n_parents;
+        int const* parents = ggit_parents_of(&graph->parents, c, &n_parents);
+        for (int j = 0; j < n_parents; ++j)
+            ggit_bitset_set(set, parents[j]);
+    }
+    return set;
+}
+/** The commit and everything that has it in its history. O(height - commit) the first time. */
+struct ggit_bitset const*
+ggit_ancestry_descendants(struct ggit_ancestry* ancestry, struct ggit_graph const* graph, int commit)
+{
+    ggit_ancestry__sync(ancestry, graph);
+
+    struct ggit_ancestry_entry* entry = ggit_ancestry__find(ancestry, commit, true);
+    if (entry)
+        return &entry->set;
+
+    struct ggit_bitset* set = &ggit_ancestry__evict(ancestry, graph, commit, true)->set;
+
+    // Mirror of ggit_ancestry_reachable, sweeping upwards over the children index.
+    for (int c = commit; c < graph->height; ++c) {
+        if (!ggit_bitset_test(set, c))
+            continue;
+        int n_children;
+        int const* children = ggit_graph_children(graph, c, &n_children);
+        for (int j = 0; j < n_children; ++j)
+            ggit_bitset_set(set, children[j]);
+    }
+    return set;
+}
+/** Is `ancestor` reachable from `descendant` (or the same commit)?
+ *
+ * Walks from the descendant, skipping every commit whose generation is not above
+ * the ancestor's - those can't lead to it.
+ */
+bool
+ggit_ancestry_is_ancestor(
+    struct ggit_ancestry* ancestry,
+    struct ggit_graph const* graph,
+    int ancestor,
+    int descendant
+)
+{
+    ggit_ancestry__sync(ancestry, graph);
+    if (ancestor == descendant)
+        return true;
+    if (ancestor > descendant)
+        return false;
+
+    struct ggit_ancestry_entry* entry = ggit_ancestry__find(ancestry, descendant, false);
+    if (entry)
+        return ggit_bitset_test(&entry->set, ancestor);
+
+    int const* generations = graph->generations;
+    int const floor = generations[ancestor];
+    if (generations[descendant] <= floor)
+        return false;
+
+    struct ggit_vector* stack = &ancestry->stack;
+    ggit_vector_clear(stack);
+    ggit_vector_push(stack, &descendant);
+
+    bool found = false;
+    while (stack->size && !found) {
+        int const c = ((int*)stack->data)[--stack->size];
+        int n_parents;
+        int const* parents = ggit_parents_of(&graph->parents, c, &n_parents);
+        for (int j = 0; j < n_parents; ++j) {
+            int const parent = parents[j];
+            if (parent == ancestor)
+                found = true;
+            if (generations[parent] <= floor
+                || ggit_bitset_test(&ancestry->visited, parent))
+                continue;
+            ggit_bitset_set(&ancestry->visited, parent);
+            ggit_vector_push(stack, &parent);
+        }
+    }
+
+    // Everything visited is older than the descendant.
+    ggit_bitset_clear_range(&ancestry->visited, 0, descendant + 1);
+    return found;
+}
+size_t
+ggit_ancestry_memory_usage(struct ggit_ancestry const* ancestry)
+{
+    size_t total = 0;
+    for (int i = 0; i < GGIT_ANCESTRY_CACHE; ++i)
+        total += ggit_bitset_memory_usage(&ancestry->cache[i].set);
+    total += ggit_bitset_memory_usage(&ancestry->visited);
+    total += (size_t)ancestry->stack.capacity * ancestry->stack.value_size;
+    return total;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "ggit-bitset.h"
+#include "ggit-graph.h"
+#include "ggit-vector.h"
+
+#include <stdint.h>
+
+/* Reachability sets kept around - refs get clicked back and forth. */
+#define GGIT_ANCESTRY_CACHE 8
+
+struct ggit_ancestry_entry
+{
+    int commit;
+    /* Set of commits above `commit` rather than below it. */
+    bool descendants;
+    uint64_t used;
+    struct ggit_bitset set;
+};
+
+/** Reachability queries over the parent edges.
+ *
+ * Full ancestor sets are bitsets, built by one sweep from the commit down to the
+ * root (parents always have smaller indices) and kept in a small LRU cache.
+ * Descendant sets are the same sweep upwards, over the children index.
+ * Single "is A an ancestor of B" questions walk from B and never step below the
+ * generation of A.
+ */
+struct ggit_ancestry
+{
+    /* graph->revision the cache is for. */
+    int revision;
+    uint64_t clock;
+    struct ggit_ancestry_entry cache[GGIT_ANCESTRY_CACHE];
+
+    struct ggit_bitset visited;
+    struct ggit_vector stack; /* int */
+};
+
+// clang-format off
+void                      ggit_ancestry_init        (struct ggit_ancestry* ancestry);
+void                      ggit_ancestry_destroy     (struct ggit_ancestry* ancestry);
+struct ggit_bitset const* ggit_ancestry_reachable   (struct ggit_ancestry* ancestry, struct ggit_graph const* graph, int commit);
+struct ggit_bitset const* ggit_ancestry_descendants (struct ggit_ancestry* ancestry, struct ggit_graph const* graph, int commit);
+bool                      ggit_ancestry_is_ancestor (struct ggit_ancestry* ancestry, struct ggit_graph const* graph, int ancestor, int descendant);
+size_t                    ggit_ancestry_memory_usage(struct ggit_ancestry const* ancestry);
+// clang-format on
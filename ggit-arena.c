@@ -0,0 +1,184 @@
+#include "ggit-arena.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct ggit_arena_block
+{
+    struct ggit_arena_block* next;
+    size_t size;
+    size_t top;
+    /* size bytes follow */
+};
+
+static void*
+ggit_heap_realloc(void* ctx, void* block, size_t old_size, size_t new_size)
+{
+    (void)ctx;
+    (void)old_size;
+    void* moved = realloc(block, new_size);
+    if (!moved) {
+        perror("[ggit_heap_realloc] OOM.");
+        abort();
+    }
+    return moved;
+}
+static void
+ggit_heap_free(void* ctx, void* block, size_t size)
+{
+    (void)ctx;
+    (void)size;
+    free(block);
+}
+struct ggit_allocator const ggit_heap_allocator = {
+    .realloc = ggit_heap_realloc,
+    .free = ggit_heap_free,
+    .ctx = 0,
+};
+
+static inline char*
+ggit_arena_block_data(struct ggit_arena_block* block)
+{
+    return (char*)(block + 1);
+}
+static void
+ggit_arena_add_block(struct ggit_arena* arena, size_t at_least)
+{
+    size_t size = arena->block_size > at_least ? arena->block_size : at_least;
+    struct ggit_arena_block* block = (struct ggit_arena_block*)malloc(sizeof(*block) + size);
+    if (!block) {
+        perror("[ggit_arena_add_block] OOM.");
+        abort();
+    }
+    block->next = arena->head;
+    block->size = size;
+    block->top = 0;
+    arena->head = block;
+    arena->reserved += size;
+    // Fewer, bigger blocks the more the load needs, up to 16MB apiece.
+    if (arena->block_size < 16 * 1024 * 1024)
+        arena->block_size *= 2;
+}
+static void
+ggit_arena_free_blocks(struct ggit_arena* arena)
+{
+    struct ggit_arena_block* block = arena->head;
+    while (block) {
+        struct ggit_arena_block* next = block->next;
+        free(block);
+        block = next;
+    }
+    arena->head = 0;
+    arena->reserved = 0;
+    arena->used = 0;
+}
+
+void
+ggit_arena_init(struct ggit_arena* arena)
+{
+    memset(arena, 0, sizeof(*arena));
+    arena->block_size = GGIT_ARENA_BLOCK_SIZE;
+}
+void
+ggit_arena_destroy(struct ggit_arena* arena)
+{
+    ggit_arena_free_blocks(arena);
+    memset(arena, 0, sizeof(*arena));
+}
+/** Forgets every allocation, keeping (at most) one block with all the memory. */
+void
+ggit_arena_reset(struct ggit_arena* arena)
+{
+    if (!arena->head)
+        return;
+    if (arena->head->next) {
+        size_t const reserved = arena->reserved;
+        ggit_arena_free_blocks(arena);
+        arena->block_size = reserved;
+        ggit_arena_add_block(arena, reserved);
+    }
+    arena->head->top = 0;
+    arena->used = 0;
+}
+/** `size` bytes aligned to `align` (a power of two), valid until the next reset. */
+void*
+ggit_arena_alloc(struct ggit_arena* arena, size_t size, size_t align)
+{
+    struct ggit_arena_block* block = arena->head;
+    if (block) {
+        uintptr_t const base = (uintptr_t)ggit_arena_block_data(block);
+        uintptr_t const at = (base + block->top + align - 1) & ~(uintptr_t)(align - 1);
+        if (at + size <= base + block->size) {
+            size_t const top = (size_t)(at - base) + size;
+            arena->used += top - block->top;
+            block->top = top;
+            return (void*)at;
+        }
+    }
+    ggit_arena_add_block(arena, size + align);
+    return ggit_arena_alloc(arena, size, align);
+}
+char*
+ggit_arena_strndup(struct ggit_arena* arena, char const* text, size_t length)
+{
+    char* copy = (char*)ggit_arena_alloc(arena, length + 1, 1);
+    memcpy(copy, text, length);
+    copy[length] = '\0';
+    return copy;
+}
+size_t
+ggit_arena_memory_usage(struct ggit_arena const* arena)
+{
+    return arena->reserved;
+}
+
+/* Is the block the last thing handed out of the arena? */
+static bool
+ggit_arena_is_top(struct ggit_arena const* arena, void const* block, size_t size)
+{
+    struct ggit_arena_block* head = arena->head;
+    return head && block && (char const*)block + size == ggit_arena_block_data(head) + head->top;
+}
+static void*
+ggit_arena_realloc(void* ctx, void* block, size_t old_size, size_t new_size)
+{
+    struct ggit_arena* arena = (struct ggit_arena*)ctx;
+    struct ggit_arena_block* head = arena->head;
+
+    // The last allocation grows (or shrinks) in place while the block has room.
+    if (ggit_arena_is_top(arena, block, old_size)) {
+        size_t const start = (size_t)((char*)block - ggit_arena_block_data(head));
+        if (start + new_size <= head->size) {
+            arena->used = arena->used - old_size + new_size;
+            head->top = start + new_size;
+            return block;
+        }
+    }
+    void* moved = ggit_arena_alloc(arena, new_size, alignof(max_align_t));
+    if (block)
+        memcpy(moved, block, old_size < new_size ? old_size : new_size);
+    return moved;
+}
+static void
+ggit_arena_free(void* ctx, void* block, size_t size)
+{
+    struct ggit_arena* arena = (struct ggit_arena*)ctx;
+    // Only the last allocation can be given back, the rest waits for the reset.
+    if (ggit_arena_is_top(arena, block, size)) {
+        arena->head->top -= size;
+        arena->used -= size;
+    }
+}
+/** Allocator handing out memory from the arena, it has to outlive whatever uses it. */
+struct ggit_allocator
+ggit_arena_allocator(struct ggit_arena* arena)
+{
+    return (struct ggit_allocator){
+        .realloc = ggit_arena_realloc,
+        .free = ggit_arena_free,
+        .ctx = arena,
+    };
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stdalign.h>
+#include <stddef.h>
+
+/** Where a container gets its memory from.
+ *
+ * realloc(ctx, 0, 0, size) allocates, free gets the size back so allocators that
+ * don't keep headers know how much went away. The heap one is malloc / realloc / free.
+ */
+struct ggit_allocator
+{
+    void* (*realloc)(void* ctx, void* block, size_t old_size, size_t new_size);
+    void (*free)(void* ctx, void* block, size_t size);
+    void* ctx;
+};
+
+extern struct ggit_allocator const ggit_heap_allocator;
+
+/* NOTE(boz):
+    Bump arena - allocations go one after another into big blocks and are only
+    ever freed all together. Everything living exactly as long as one load of the
+    graph (hashes, ref names, interned strings) goes into one, so clearing the graph
+    is a free per block instead of one per string.
+
+    Resetting keeps the memory: several blocks get merged into one big enough for
+    all of them, so reloading the same repository bumps through a single block.
+*/
+struct ggit_arena_block;
+struct ggit_arena
+{
+    struct ggit_arena_block* head; /* the block being bumped, older ones behind it */
+    size_t block_size;             /* the next block is at least this big */
+    size_t used;                   /* bytes handed out since the last reset */
+    size_t reserved;               /* bytes in all the blocks */
+};
+
+#define GGIT_ARENA_BLOCK_SIZE (64 * 1024)
+
+// clang-format off
+void   ggit_arena_init        (struct ggit_arena* arena);
+void   ggit_arena_destroy     (struct ggit_arena* arena);
+void   ggit_arena_reset       (struct ggit_arena* arena);
+void*  ggit_arena_alloc       (struct ggit_arena* arena, size_t size, size_t align);
+char*  ggit_arena_strndup     (struct ggit_arena* arena, char const* text, size_t length);
+size_t ggit_arena_memory_usage(struct ggit_arena const* arena);
+
+struct ggit_allocator ggit_arena_allocator(struct ggit_arena* arena);
+// clang-format on
+
+#define GGIT_ARENA_NEW(arena, type, count) \
+    ((type*)ggit_arena_alloc((arena), sizeof(type) * (count), alignof(type)))
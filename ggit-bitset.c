@@ -0,0 +1,174 @@
+#include "ggit-bitset.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+/* Mask of the bits [begin, 64) of a word. */
+static inline uint64_t
+mask_from(int begin)
+{
+    return ~(uint64_t)0 << (begin & 63);
+}
+/* Mask of the bits [0, end) of a word, end in [1, 64]. */
+static inline uint64_t
+mask_until(int end)
+{
+    return ~(uint64_t)0 >> ((64 - end) & 63);
+}
+
+void
+ggit_bitset_init(struct ggit_bitset* bs)
+{
+    memset(bs, 0, sizeof(*bs));
+}
+void
+ggit_bitset_destroy(struct ggit_bitset* bs)
+{
+    free(bs->words);
+    memset(bs, 0, sizeof(*bs));
+}
+/** Resizes the bitset to `size` bits, all of them cleared. */
+void
+ggit_bitset_resize(struct ggit_bitset* bs, int size)
+{
+    int const n_words = ggit_bitset_words(size);
+    if (n_words > bs->capacity) {
+        free(bs->words);
+        bs->words = (uint64_t*)calloc(n_words, sizeof(uint64_t));
+        if (!bs->words) {
+            perror("[ggit_bitset_resize] OOM.");
+            abort();
+        }
+        bs->capacity = n_words;
+    }
+    bs->size = size;
+    ggit_bitset_clear(bs);
+}
+void
+ggit_bitset_clear(struct ggit_bitset* bs)
+{
+    if (bs->capacity)
+        memset(bs->words, 0, bs->capacity * sizeof(uint64_t));
+}
+void
+ggit_bitset_copy(struct ggit_bitset* restrict dst, struct ggit_bitset const* restrict src)
+{
+    if (dst->size != src->size)
+        ggit_bitset_resize(dst, src->size);
+    memcpy(dst->words, src->words, ggit_bitset_words(src->size) * sizeof(uint64_t));
+}
+/** Sets [begin, end) - whole words at a time. */
+void
+ggit_bitset_set_range(struct ggit_bitset* bs, int begin, int end)
+{
+    assert(begin >= 0 && end <= bs->size);
+    if (begin >= end)
+        return;
+
+    int const w_begin = begin >> 6;
+    int const w_last = (end - 1) >> 6;
+    if (w_begin == w_last) {
+        bs->words[w_begin] |= mask_from(begin) & mask_until(end - (w_last << 6));
+        return;
+    }
+
+    bs->words[w_begin] |= mask_from(begin);
+    for (int w = w_begin + 1; w < w_last; ++w)
+        bs->words[w] = ~(uint64_t)0;
+    bs->words[w_last] |= mask_until(end - (w_last << 6));
+}
+/** Clears [begin, end) - whole words at a time. */
+void
+ggit_bitset_clear_range(struct ggit_bitset* bs, int begin, int end)
+{
+    assert(begin >= 0 && end <= bs->size);
+    if (begin >= end)
+        return;
+
+    int const w_begin = begin >> 6;
+    int const w_last = (end - 1) >> 6;
+    if (w_begin == w_last) {
+        bs->words[w_begin] &= ~(mask_from(begin) & mask_until(end - (w_last << 6)));
+        return;
+    }
+
+    bs->words[w_begin] &= ~mask_from(begin);
+    for (int w = w_begin + 1; w < w_last; ++w)
+        bs->words[w] = 0;
+    bs->words[w_last] &= ~mask_until(end - (w_last << 6));
+}
+void
+ggit_bitset_or(struct ggit_bitset* restrict dst, struct ggit_bitset const* restrict src)
+{
+    assert(dst->size == src->size);
+    int const n_words = ggit_bitset_words(dst->size);
+    for (int w = 0; w < n_words; ++w)
+        dst->words[w] |= src->words[w];
+}
+void
+ggit_bitset_and(struct ggit_bitset* restrict dst, struct ggit_bitset const* restrict src)
+{
+    assert(dst->size == src->size);
+    int const n_words = ggit_bitset_words(dst->size);
+    for (int w = 0; w < n_words; ++w)
+        dst->words[w] &= src->words[w];
+}
+void
+ggit_bitset_and_not(
+    struct ggit_bitset* restrict dst,
+    struct ggit_bitset const* restrict src
+)
+{
+    assert(dst->size == src->size);
+    int const n_words = ggit_bitset_words(dst->size);
+    for (int w = 0; w < n_words; ++w)
+        dst->words[w] &= ~src->words[w];
+}
+int
+ggit_bitset_count(struct ggit_bitset const* bs)
+{
+    int count = 0;
+    int const n_words = ggit_bitset_words(bs->size);
+    for (int w = 0; w < n_words; ++w)
+        count += ggit_popcount64(bs->words[w]);
+    return count;
+}
+/** First set bit at or after `from`, -1 if there is none. */
+int
+ggit_bitset_next(struct ggit_bitset const* bs, int from)
+{
+    if (from < 0)
+        from = 0;
+    if (from >= bs->size)
+        return -1;
+
+    int const n_words = ggit_bitset_words(bs->size);
+    int w = from >> 6;
+    uint64_t word = bs->words[w] & mask_from(from);
+    while (!word) {
+        if (++w == n_words)
+            return -1;
+        word = bs->words[w];
+    }
+    return (w << 6) + ggit_ctz64(word);
+}
+/** Last set bit at or before `from`, -1 if there is none. */
+int
+ggit_bitset_prev(struct ggit_bitset const* bs, int from)
+{
+    if (from >= bs->size)
+        from = bs->size - 1;
+    if (from < 0)
+        return -1;
+
+    int w = from >> 6;
+    uint64_t word = bs->words[w] & mask_until((from & 63) + 1);
+    while (!word) {
+        if (--w < 0)
+            return -1;
+        word = bs->words[w];
+    }
+    return (w << 6) + ggit_msb64(word);
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/* One bit per row/commit. Bits past `size` in the last word are always zero. */
+struct ggit_bitset
+{
+    uint64_t* words;
+    int size;
+    int capacity;
+};
+
+// clang-format off
+void ggit_bitset_init       (struct ggit_bitset* bs);
+void ggit_bitset_destroy    (struct ggit_bitset* bs);
+void ggit_bitset_resize     (struct ggit_bitset* bs, int size);
+void ggit_bitset_clear      (struct ggit_bitset* bs);
+void ggit_bitset_copy       (struct ggit_bitset* restrict dst, struct ggit_bitset const* restrict src);
+void ggit_bitset_set_range  (struct ggit_bitset* bs, int begin, int end);
+void ggit_bitset_clear_range(struct ggit_bitset* bs, int begin, int end);
+void ggit_bitset_or         (struct ggit_bitset* restrict dst, struct ggit_bitset const* restrict src);
+void ggit_bitset_and        (struct ggit_bitset* restrict dst, struct ggit_bitset const* restrict src);
+void ggit_bitset_and_not    (struct ggit_bitset* restrict dst, struct ggit_bitset const* restrict src);
+int  ggit_bitset_count      (struct ggit_bitset const* bs);
+int  ggit_bitset_next       (struct ggit_bitset const* bs, int from);
+int  ggit_bitset_prev       (struct ggit_bitset const* bs, int from);
+// clang-format on
+
+static inline int
+ggit_bitset_words(int size)
+{
+    return (size + 63) >> 6;
+}
+static inline size_t
+ggit_bitset_memory_usage(struct ggit_bitset const* bs)
+{
+    return (size_t)bs->capacity * sizeof(uint64_t);
+}
+static inline bool
+ggit_bitset_test(struct ggit_bitset const* bs, int i)
+{
+    return (bs->words[i >> 6] >> (i & 63)) & 1;
+}
+static inline void
+ggit_bitset_set(struct ggit_bitset* bs, int i)
+{
+    bs->words[i >> 6] |= (uint64_t)1 << (i & 63);
+}
+static inline void
+ggit_bitset_unset(struct ggit_bitset* bs, int i)
+{
+    bs->words[i >> 6] &= ~((uint64_t)1 << (i & 63));
+}
+static inline void
+ggit_bitset_flip(struct ggit_bitset* bs, int i)
+{
+    bs->words[i >> 6] ^= (uint64_t)1 << (i & 63);
+}
+
+static inline int
+ggit_popcount64(uint64_t x)
+{
+#ifdef _MSC_VER
+    return (int)__popcnt64(x);
+#else
+    return __builtin_popcountll(x);
+#endif
+}
+/* Index of the lowest set bit. x must not be 0. */
+static inline int
+ggit_ctz64(uint64_t x)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, x);
+    return (int)index;
+#else
+    return __builtin_ctzll(x);
+#endif
+}
+/* Index of the highest set bit. x must not be 0. */
+static inline int
+ggit_msb64(uint64_t x)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse64(&index, x);
+    return (int)index;
+#else
+    return 63 - __builtin_clzll(x);
+#endif
+}
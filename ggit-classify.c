@@ -0,0 +1,546 @@
+#include "ggit-classify.h"
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+enum ggit_classify_quantifier
+{
+    ggit_classify_one,
+    ggit_classify_star,
+    ggit_classify_optional,
+};
+
+struct ggit_classify_atom
+{
+    uint64_t bytes[4];
+    int quantifier;
+};
+
+GGIT_GENERATE_VECTOR_REF_GETTER(struct ggit_classify_atom, classify_atom)
+
+static bool
+ggit_classify_has(struct ggit_classify_atom const* atom, int byte)
+{
+    return (atom->bytes[byte >> 6] >> (byte & 63)) & 1;
+}
+static void
+ggit_classify_set(struct ggit_classify_atom* atom, int byte)
+{
+    atom->bytes[byte >> 6] |= (uint64_t)1 << (byte & 63);
+}
+static void
+ggit_classify_set_range(struct ggit_classify_atom* atom, int first, int last)
+{
+    for (int b = first; b <= last; ++b)
+        ggit_classify_set(atom, b);
+}
+static void
+ggit_classify_invert(struct ggit_classify_atom* atom)
+{
+    for (int w = 0; w < 4; ++w)
+        atom->bytes[w] = ~atom->bytes[w];
+}
+/* \d \w \s and their negations, false if `c` isn't one of them. */
+static bool
+ggit_classify_escape_class(struct ggit_classify_atom* atom, char c)
+{
+    struct ggit_classify_atom set = { 0 };
+    switch (c | 0x20) {
+        case 'd': ggit_classify_set_range(&set, '0', '9'); break;
+        case 'w':
+            ggit_classify_set_range(&set, '0', '9');
+            ggit_classify_set_range(&set, 'a', 'z');
+            ggit_classify_set_range(&set, 'A', 'Z');
+            ggit_classify_set(&set, '_');
+            break;
+        case 's':
+            ggit_classify_set_range(&set, '\t', '\r');
+            ggit_classify_set(&set, ' ');
+            break;
+        default: return false;
+    }
+    if (c >= 'A' && c <= 'Z')
+        ggit_classify_invert(&set);
+    for (int w = 0; w < 4; ++w)
+        atom->bytes[w] |= set.bytes[w];
+    return true;
+}
+/* [abc], [^a-z], escapes inside. Returns what follows the ']', 0 if it doesn't parse. */
+static char const*
+ggit_classify_parse_class(char const* p, struct ggit_classify_atom* atom)
+{
+    bool const negate = *p == '^';
+    if (negate)
+        ++p;
+    bool empty = true;
+    while (*p && *p != ']') {
+        int first = (uint8_t)*p;
+        if (*p == '\\') {
+            if (!p[1])
+                return 0;
+            if (ggit_classify_escape_class(atom, p[1])) {
+                p += 2;
+                empty = false;
+                continue;
+            }
+            first = (uint8_t)p[1];
+            ++p;
+        }
+        ++p;
+        int last = first;
+        if (p[0] == '-' && p[1] && p[1] != ']') {
+            last = (uint8_t)p[1];
+            p += 2;
+        }
+        if (last < first)
+            return 0;
+        ggit_classify_set_range(atom, first, last);
+        empty = false;
+    }
+    if (*p != ']' || empty)
+        return 0;
+    if (negate)
+        ggit_classify_invert(atom);
+    return p + 1;
+}
+/** Appends the atoms of `pattern`, false if it's outside of what the DFA knows. */
+static bool
+ggit_classify_parse(char const* pattern, struct ggit_vector* atoms, bool* out_end_anchored)
+{
+    char const* p = pattern;
+    if (*p == '^')
+        ++p;
+
+    *out_end_anchored = false;
+    while (*p) {
+        struct ggit_classify_atom atom = { { 0 }, ggit_classify_one };
+        switch (*p) {
+            case '$':
+                if (p[1])
+                    return false;
+                *out_end_anchored = true;
+                return true;
+            case '|':
+            case '(':
+            case ')':
+            case '{':
+            case '}':
+            case '*':
+            case '+':
+            case '?': return false;
+            case '.':
+                ggit_classify_invert(&atom);
+                ++p;
+                break;
+            case '[':
+                p = ggit_classify_parse_class(p + 1, &atom);
+                if (!p)
+                    return false;
+                break;
+            case '\\':
+                if (!p[1])
+                    return false;
+                if (!ggit_classify_escape_class(&atom, p[1]))
+                    ggit_classify_set(&atom, (uint8_t)p[1]);
+                p += 2;
+                break;
+            default:
+                ggit_classify_set(&atom, (uint8_t)*p);
+                ++p;
+                break;
+        }
+
+        switch (*p) {
+            case '*': atom.quantifier = ggit_classify_star; ++p; break;
+            case '?': atom.quantifier = ggit_classify_optional; ++p; break;
+            case '+':
+                // a+ = aa*
+                ggit_vector_push(atoms, &atom);
+                atom.quantifier = ggit_classify_star;
+                ++p;
+                break;
+        }
+        if (*p == '*' || *p == '+' || *p == '?')
+            return false;
+        ggit_vector_push(atoms, &atom);
+    }
+    return true;
+}
+
+/* NOTE(boz):
+    Positions - pattern p with k of its atoms matched is position base[p] + k,
+    base[p] + n_atoms(p) is the pattern being done. A DFA state is a set of them.
+*/
+struct ggit_classify_program
+{
+    int n_positions;
+    int words;
+    /* Per position - the atom that comes next, -1 when done. */
+    int* position_atoms;
+    int* position_patterns;
+    bool* end_anchored;
+    struct ggit_classify_atom const* atoms;
+};
+
+static void
+ggit_classify_closure(struct ggit_classify_program const* program, uint64_t* set)
+{
+    // Skipping an atom only goes forward, one sweep is enough.
+    for (int pos = 0; pos < program->n_positions; ++pos) {
+        if (!((set[pos >> 6] >> (pos & 63)) & 1))
+            continue;
+        int const atom = program->position_atoms[pos];
+        if (atom != -1 && program->atoms[atom].quantifier != ggit_classify_one)
+            set[(pos + 1) >> 6] |= (uint64_t)1 << ((pos + 1) & 63);
+    }
+}
+/* Once a pattern matched, it and everything after it can't win any more - drops them. */
+static void
+ggit_classify_prune(
+    struct ggit_classify_program const* program,
+    uint64_t* set,
+    int* out_accept,
+    int* out_end_accept
+)
+{
+    int accept = INT_MAX;
+    int end_accept = INT_MAX;
+    for (int pos = 0; pos < program->n_positions; ++pos) {
+        if (!((set[pos >> 6] >> (pos & 63)) & 1) || program->position_atoms[pos] != -1)
+            continue;
+        int const pattern = program->position_patterns[pos];
+        if (!program->end_anchored[pattern])
+            accept = pattern < accept ? pattern : accept;
+    }
+    for (int pos = 0; pos < program->n_positions; ++pos) {
+        if (!((set[pos >> 6] >> (pos & 63)) & 1))
+            continue;
+        int const pattern = program->position_patterns[pos];
+        if (pattern >= accept) {
+            set[pos >> 6] &= ~((uint64_t)1 << (pos & 63));
+        } else if (program->position_atoms[pos] == -1) {
+            end_accept = pattern < end_accept ? pattern : end_accept;
+        }
+    }
+    *out_accept = accept;
+    *out_end_accept = end_accept;
+}
+static bool
+ggit_classify_empty(uint64_t const* set, int words)
+{
+    for (int w = 0; w < words; ++w) {
+        if (set[w])
+            return false;
+    }
+    return true;
+}
+/* The state with this set of positions, added if it's new. -1 if there are too many. */
+static int
+ggit_classify_state(
+    struct ggit_classifier* classifier,
+    struct ggit_classify_program const* program,
+    struct ggit_vector* sets,
+    uint64_t const* set,
+    int accept,
+    int end_accept
+)
+{
+    size_t const bytes = program->words * sizeof(uint64_t);
+    int const n_states = classifier->accepts.size;
+    int const* accepts = (int const*)classifier->accepts.data;
+    int const* end_accepts = (int const*)classifier->end_accepts.data;
+    for (int s = 0; s < n_states; ++s) {
+        // Pruned sets can be the same with different patterns matched on the way.
+        if (accepts[s] != accept || end_accepts[s] != end_accept)
+            continue;
+        uint64_t const* other = (uint64_t const*)sets->data + (size_t)s * program->words;
+        if (0 == memcmp(other, set, bytes))
+            return s;
+    }
+    if (n_states == GGIT_CLASSIFY_MAX_STATES)
+        return -1;
+
+    for (int w = 0; w < program->words; ++w)
+        ggit_vector_push(sets, set + w);
+    ggit_vector_push(&classifier->accepts, &accept);
+    ggit_vector_push(&classifier->end_accepts, &end_accept);
+    return n_states;
+}
+/* Subset construction. False if it went over GGIT_CLASSIFY_MAX_STATES. */
+static bool
+ggit_classify_build_dfa(
+    struct ggit_classifier* classifier,
+    struct ggit_classify_program const* program,
+    int const* pattern_bases,
+    int count,
+    bool const* compiled
+)
+{
+    int representatives[256];
+    for (int b = 255; b >= 0; --b)
+        representatives[classifier->classes[b]] = b;
+
+    struct ggit_vector sets;
+    ggit_vector_init(&sets, sizeof(uint64_t));
+    uint64_t* set = (uint64_t*)calloc(program->words, sizeof(uint64_t));
+    if (!set) {
+        perror("[ggit_classify_build_dfa] OOM.");
+        abort();
+    }
+
+    for (int p = 0; p < count; ++p) {
+        if (compiled[p])
+            set[pattern_bases[p] >> 6] |= (uint64_t)1 << (pattern_bases[p] & 63);
+    }
+    ggit_classify_closure(program, set);
+    int accept;
+    int end_accept;
+    ggit_classify_prune(program, set, &accept, &end_accept);
+    ggit_classify_state(classifier, program, &sets, set, accept, end_accept);
+
+    bool ok = true;
+    for (int s = 0; ok && s < classifier->accepts.size; ++s) {
+        for (int c = 0; c < classifier->n_classes; ++c) {
+            int const byte = representatives[c];
+            uint64_t const* from = (uint64_t const*)sets.data + (size_t)s * program->words;
+            memset(set, 0, program->words * sizeof(uint64_t));
+            for (int pos = 0; pos < program->n_positions; ++pos) {
+                int const atom = program->position_atoms[pos];
+                if (atom == -1 || !((from[pos >> 6] >> (pos & 63)) & 1))
+                    continue;
+                if (!ggit_classify_has(program->atoms + atom, byte))
+                    continue;
+                int const to = program->atoms[atom].quantifier == ggit_classify_star
+                                   ? pos
+                                   : pos + 1;
+                set[to >> 6] |= (uint64_t)1 << (to & 63);
+            }
+
+            int next = -1;
+            if (!ggit_classify_empty(set, program->words)) {
+                ggit_classify_closure(program, set);
+                ggit_classify_prune(program, set, &accept, &end_accept);
+                next = ggit_classify_state(
+                    classifier,
+                    program,
+                    &sets,
+                    set,
+                    accept,
+                    end_accept
+                );
+                if (next == -1) {
+                    ok = false;
+                    break;
+                }
+            }
+            ggit_vector_push(&classifier->transitions, &next);
+        }
+    }
+
+    free(set);
+    ggit_vector_destroy(&sets);
+    return ok;
+}
+
+void
+ggit_classifier_init(struct ggit_classifier* classifier)
+{
+    memset(classifier, 0, sizeof(*classifier));
+    ggit_vector_init(&classifier->transitions, sizeof(int));
+    ggit_vector_init(&classifier->accepts, sizeof(int));
+    ggit_vector_init(&classifier->end_accepts, sizeof(int));
+    ggit_vector_init(&classifier->fallback_patterns, sizeof(int));
+    ggit_vector_init(&classifier->fallback_regexes, sizeof(struct small_regex*));
+}
+void
+ggit_classifier_destroy(struct ggit_classifier* classifier)
+{
+    ggit_vector_destroy(&classifier->transitions);
+    ggit_vector_destroy(&classifier->accepts);
+    ggit_vector_destroy(&classifier->end_accepts);
+    ggit_vector_destroy(&classifier->fallback_patterns);
+    ggit_vector_destroy(&classifier->fallback_regexes);
+}
+/** Compiles the patterns (in priority order) into the DFA.
+ *
+ * regexes[i] is the same pattern compiled by small-regex, used when the DFA can't
+ * take it. Both may be 0 - a pattern that never matches. The regexes aren't owned.
+ */
+void
+ggit_classifier_build(
+    struct ggit_classifier* classifier,
+    int count,
+    char const* const* patterns,
+    struct small_regex* const* regexes
+)
+{
+    classifier->n_patterns = count;
+    classifier->transitions.size = 0;
+    classifier->accepts.size = 0;
+    classifier->end_accepts.size = 0;
+    classifier->fallback_patterns.size = 0;
+    classifier->fallback_regexes.size = 0;
+
+    struct ggit_vector atoms;
+    ggit_vector_init(&atoms, sizeof(struct ggit_classify_atom));
+    int* atom_bases = (int*)malloc((count + 1) * sizeof(int));
+    int* pattern_bases = (int*)malloc((count + 1) * sizeof(int));
+    bool* end_anchored = (bool*)calloc(count + 1, sizeof(bool));
+    bool* compiled = (bool*)calloc(count + 1, sizeof(bool));
+    if (!atom_bases || !pattern_bases || !end_anchored || !compiled) {
+        perror("[ggit_classifier_build] OOM.");
+        abort();
+    }
+
+    for (int p = 0; p < count; ++p) {
+        atom_bases[p] = atoms.size;
+        compiled[p] = patterns[p]
+                      && ggit_classify_parse(patterns[p], &atoms, end_anchored + p);
+        if (!compiled[p])
+            atoms.size = atom_bases[p];
+    }
+    atom_bases[count] = atoms.size;
+
+    /* NOTE(boz):
+        Bytes no pattern tells apart share a class - the names are mostly
+        letters and '/', so the transition table stays small.
+    */
+    memset(classifier->classes, 0, sizeof(classifier->classes));
+    classifier->n_classes = 1;
+    for (int a = 0; a < atoms.size; ++a) {
+        struct ggit_classify_atom const* atom = ggit_vector_ref_classify_atom(&atoms, a);
+        int split[512];
+        memset(split, 0xFF, 2 * classifier->n_classes * sizeof(int));
+        int n_classes = 0;
+        for (int b = 0; b < 256; ++b) {
+            int const key = classifier->classes[b] * 2 + ggit_classify_has(atom, b);
+            if (split[key] == -1)
+                split[key] = n_classes++;
+            classifier->classes[b] = (uint8_t)split[key];
+        }
+        classifier->n_classes = n_classes;
+    }
+
+    int n_positions = 0;
+    for (int p = 0; p < count; ++p) {
+        pattern_bases[p] = n_positions;
+        n_positions += atom_bases[p + 1] - atom_bases[p] + 1;
+    }
+    struct ggit_classify_program program = {
+        .n_positions = n_positions,
+        .words = (n_positions + 64) / 64,
+        .position_atoms = (int*)malloc(n_positions * sizeof(int)),
+        .position_patterns = (int*)malloc(n_positions * sizeof(int)),
+        .end_anchored = end_anchored,
+        .atoms = (struct ggit_classify_atom const*)atoms.data,
+    };
+    if (!program.position_atoms || !program.position_patterns) {
+        perror("[ggit_classifier_build] OOM.");
+        abort();
+    }
+    for (int p = 0; p < count; ++p) {
+        int const n_atoms = atom_bases[p + 1] - atom_bases[p];
+        for (int k = 0; k <= n_atoms; ++k) {
+            program.position_atoms[pattern_bases[p] + k] = k < n_atoms ? atom_bases[p] + k
+                                                                       : -1;
+            program.position_patterns[pattern_bases[p] + k] = p;
+        }
+    }
+
+    if (!ggit_classify_build_dfa(classifier, &program, pattern_bases, count, compiled)) {
+        fprintf(
+            stderr,
+            "Branch patterns need over %d DFA states, matching them one by one.\n",
+            GGIT_CLASSIFY_MAX_STATES
+        );
+        classifier->transitions.size = 0;
+        classifier->accepts.size = 0;
+        classifier->end_accepts.size = 0;
+        memset(compiled, 0, count * sizeof(bool));
+    }
+
+    for (int p = 0; p < count; ++p) {
+        if (compiled[p] || !regexes[p])
+            continue;
+        ggit_vector_push(&classifier->fallback_patterns, &p);
+        ggit_vector_push(&classifier->fallback_regexes, &regexes[p]);
+    }
+
+    free(program.position_atoms);
+    free(program.position_patterns);
+    free(atom_bases);
+    free(pattern_bases);
+    free(end_anchored);
+    free(compiled);
+    ggit_vector_destroy(&atoms);
+}
+/** Lowest index pattern matching at the start of the name, -1 if none does.
+ *
+ * `name` has to be NUL terminated when some pattern went to small-regex.
+ */
+int
+ggit_classifier_match(struct ggit_classifier const* classifier, char const* name, int length)
+{
+    int best = INT_MAX;
+    if (classifier->accepts.size) {
+        int const* transitions = (int const*)classifier->transitions.data;
+        int const* accepts = (int const*)classifier->accepts.data;
+        int const n_classes = classifier->n_classes;
+
+        // Every state only holds patterns below the ones matched on the way to it.
+        int s = 0;
+        best = accepts[0];
+        int i = 0;
+        for (; i < length; ++i) {
+            s = transitions[s * n_classes + classifier->classes[(uint8_t)name[i]]];
+            if (s == -1)
+                break;
+            best = accepts[s] < best ? accepts[s] : best;
+        }
+        if (s != -1) {
+            int const end_accept = ((int const*)classifier->end_accepts.data)[s];
+            best = end_accept < best ? end_accept : best;
+        }
+    }
+
+    int const* fallback_patterns = (int const*)classifier->fallback_patterns.data;
+    struct small_regex* const* fallback_regexes = (struct small_regex* const*)
+                                                      classifier->fallback_regexes.data;
+    for (int f = 0; f < classifier->fallback_patterns.size; ++f) {
+        if (fallback_patterns[f] >= best)
+            break;
+        if (regex_matchp(fallback_regexes[f], name) == 0) {
+            best = fallback_patterns[f];
+            break;
+        }
+    }
+    return best == INT_MAX ? -1 : best;
+}
+void
+ggit_classifier_match_batch(
+    struct ggit_classifier const* classifier,
+    int count,
+    char const* const* names,
+    int const* lengths,
+    int* out_patterns
+)
+{
+    for (int i = 0; i < count; ++i)
+        out_patterns[i] = ggit_classifier_match(classifier, names[i], lengths[i]);
+}
+size_t
+ggit_classifier_memory_usage(struct ggit_classifier const* classifier)
+{
+    size_t total = 0;
+    total += (size_t)classifier->transitions.capacity * classifier->transitions.value_size;
+    total += (size_t)classifier->accepts.capacity * classifier->accepts.value_size;
+    total += (size_t)classifier->end_accepts.capacity * classifier->end_accepts.value_size;
+    total += (size_t)classifier->fallback_patterns.capacity
+             * classifier->fallback_patterns.value_size;
+    total += (size_t)classifier->fallback_regexes.capacity
+             * classifier->fallback_regexes.value_size;
+    return total;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "ggit-vector.h"
+
+#include <stddef.h>
+
+#include <libsmallregex.h>
+
+/* More DFA states than this and every pattern goes through small-regex instead. */
+#define GGIT_CLASSIFY_MAX_STATES 4096
+
+/** All the special branch patterns in one DFA.
+ *
+ * A name is walked once and comes out with the lowest index pattern that matches
+ * at its start - what running regex_matchp() on every pattern in order and taking
+ * the first one returning 0 gives.
+ *
+ * The DFA knows the small-regex subset without alternatives: literals, '.', [classes],
+ * \d \w \s (and negations), '*' '+' '?', '^' at the start and '$' at the end.
+ * Whatever else is handed to small-regex, but only for patterns with a lower index
+ * than what the DFA found.
+ */
+struct ggit_classifier
+{
+    int n_patterns;
+    int n_classes;
+    uint8_t classes[256];
+
+    /* State s on byte class c goes to transitions[s * n_classes + c], -1 = dead. */
+    /* [int] */ struct ggit_vector transitions;
+    /* Lowest pattern matched once the state is reached, INT_MAX if none. */
+    /* [int] */ struct ggit_vector accepts;
+    /* Same for patterns ending in '$', only good at the end of the name. */
+    /* [int] */ struct ggit_vector end_accepts;
+
+    /* [int] */ struct ggit_vector fallback_patterns;
+    /* [struct small_regex*] */ struct ggit_vector fallback_regexes;
+};
+
+// clang-format off
+void   ggit_classifier_init        (struct ggit_classifier* classifier);
+void   ggit_classifier_destroy     (struct ggit_classifier* classifier);
+void   ggit_classifier_build       (struct ggit_classifier* classifier, int count, char const* const* patterns, struct small_regex* const* regexes);
+int    ggit_classifier_match       (struct ggit_classifier const* classifier, char const* name, int length);
+void   ggit_classifier_match_batch (struct ggit_classifier const* classifier, int count, char const* const* names, int const* lengths, int* out_patterns);
+size_t ggit_classifier_memory_usage(struct ggit_classifier const* classifier);
+// clang-format on
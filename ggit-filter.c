@@ -0,0 +1,241 @@
+#include "ggit-filter.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+struct ggit_filter_time
+{
+    int64_t time;
+    int commit;
+};
+
+static void*
+ggit_filter_alloc(size_t count, size_t size)
+{
+    void* block = calloc(count ? count : 1, size);
+    if (!block) {
+        perror("[ggit_filter_index_build] OOM.");
+        abort();
+    }
+    return block;
+}
+static int
+ggit_filter_time_compare(void const* a, void const* b)
+{
+    struct ggit_filter_time const* ta = (struct ggit_filter_time const*)a;
+    struct ggit_filter_time const* tb = (struct ggit_filter_time const*)b;
+    if (ta->time != tb->time)
+        return ta->time < tb->time ? -1 : 1;
+    return ta->commit - tb->commit;
+}
+/* First index in the sorted `times` that is >= time. */
+static int
+lower_bound(int64_t const* times, int count, int64_t time)
+{
+    int lo = 0;
+    int hi = count;
+    while (lo < hi) {
+        int const mid = lo + (hi - lo) / 2;
+        if (times[mid] < time)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+static bool
+contains_nocase(char const* haystack, char const* needle)
+{
+    int const needle_len = (int)strlen(needle);
+    for (; *haystack; ++haystack) {
+        int i = 0;
+        while (i < needle_len && haystack[i]
+               && tolower((unsigned char)haystack[i]) == tolower((unsigned char)needle[i]))
+            ++i;
+        if (i == needle_len)
+            return true;
+    }
+    return needle_len == 0;
+}
+/* Days since 1970-01-01 of a proleptic Gregorian date. */
+static int64_t
+days_from_civil(int64_t y, int m, int d)
+{
+    y -= m <= 2;
+    int64_t const era = (y >= 0 ? y : y - 399) / 400;
+    int64_t const yoe = y - era * 400;
+    int64_t const doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    int64_t const doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+/* "YYYY-MM-DD" to unix seconds at the start of that day (UTC). */
+static bool
+parse_date(char const* text, int64_t* out_time)
+{
+    int y, m, d;
+    if (sscanf(text, "%d-%d-%d", &y, &m, &d) != 3 || m < 1 || m > 12 || d < 1 || d > 31)
+        return false;
+    *out_time = days_from_civil(y, m, d) * 86400;
+    return true;
+}
+
+void
+ggit_filter_index_init(struct ggit_filter_index* index)
+{
+    memset(index, 0, sizeof(*index));
+    index->revision = -1;
+}
+void
+ggit_filter_index_destroy(struct ggit_filter_index* index)
+{
+    free(index->by_time);
+    free(index->times);
+    free(index->author_offsets);
+    free(index->author_commits);
+    ggit_filter_index_init(index);
+}
+size_t
+ggit_filter_index_memory_usage(struct ggit_filter_index const* index)
+{
+    size_t const height = (size_t)index->height;
+    size_t total = 0;
+    if (index->by_time) {
+        total += height * sizeof(*index->by_time);
+        total += height * sizeof(*index->times);
+        total += (size_t)(index->n_authors + 1) * sizeof(*index->author_offsets);
+        total += height * sizeof(*index->author_commits);
+    }
+    return total;
+}
+void
+ggit_filter_index_build(struct ggit_filter_index* index, struct ggit_graph const* graph)
+{
+    ggit_filter_index_destroy(index);
+
+    int const height = graph->height;
+    int const n_authors = ggit_intern_count(&graph->authors);
+    index->revision = graph->revision;
+    index->height = height;
+    index->n_authors = n_authors;
+
+    struct ggit_filter_time* sorted = (struct ggit_filter_time*)ggit_filter_alloc(
+        height,
+        sizeof(struct ggit_filter_time)
+    );
+    for (int c = 0; c < height; ++c)
+        sorted[c] = (struct ggit_filter_time){ graph->commit_times[c], c };
+    qsort(sorted, height, sizeof(*sorted), ggit_filter_time_compare);
+
+    index->by_time = (int*)ggit_filter_alloc(height, sizeof(int));
+    index->times = (int64_t*)ggit_filter_alloc(height, sizeof(int64_t));
+    for (int i = 0; i < height; ++i) {
+        index->by_time[i] = sorted[i].commit;
+        index->times[i] = sorted[i].time;
+    }
+    free(sorted);
+
+    // Counting sort into the posting lists, commits stay in ascending order.
+    index->author_offsets = (int*)ggit_filter_alloc(n_authors + 1, sizeof(int));
+    index->author_commits = (int*)ggit_filter_alloc(height, sizeof(int));
+    for (int c = 0; c < height; ++c)
+        index->author_offsets[graph->author_ids[c] + 1] += 1;
+    for (int a = 0; a < n_authors; ++a)
+        index->author_offsets[a + 1] += index->author_offsets[a];
+
+    int* fill = (int*)ggit_filter_alloc(n_authors + 1, sizeof(int));
+    memcpy(fill, index->author_offsets, (n_authors + 1) * sizeof(int));
+    for (int c = 0; c < height; ++c)
+        index->author_commits[fill[graph->author_ids[c]]++] = c;
+    free(fill);
+}
+
+bool
+ggit_filter_is_empty(struct ggit_filter const* filter)
+{
+    return !filter->since && !filter->until && !filter->author[0];
+}
+/** Parses "author:<name> since:<YYYY-MM-DD> until:<YYYY-MM-DD>".
+ *
+ * Words without a key are added to the author name, so "author:John Smith" works.
+ */
+bool
+ggit_filter_parse(struct ggit_filter* filter, char const* text)
+{
+    memset(filter, 0, sizeof(*filter));
+
+    int author_len = 0;
+    while (*text) {
+        while (*text == ' ')
+            ++text;
+        char const* end = text;
+        while (*end && *end != ' ')
+            ++end;
+        if (end == text)
+            break;
+
+        if (0 == strncmp(text, "since:", 6)) {
+            if (!parse_date(text + 6, &filter->since))
+                return false;
+        } else if (0 == strncmp(text, "until:", 6)) {
+            if (!parse_date(text + 6, &filter->until))
+                return false;
+            filter->until += 86400 - 1;
+        } else {
+            char const* word = text;
+            if (0 == strncmp(word, "author:", 7))
+                word += 7;
+
+            int const word_len = (int)(end - word);
+            if (author_len + word_len + 2 > (int)sizeof(filter->author))
+                return false;
+            if (author_len && word_len)
+                filter->author[author_len++] = ' ';
+            memcpy(filter->author + author_len, word, word_len);
+            author_len += word_len;
+            filter->author[author_len] = '\0';
+        }
+        text = end;
+    }
+    return true;
+}
+/** Sets the bits of the commits that pass the filter, clears the others. */
+void
+ggit_filter_apply(
+    struct ggit_filter_index const* index,
+    struct ggit_graph const* graph,
+    struct ggit_filter const* filter,
+    struct ggit_bitset* out_commits
+)
+{
+    int const height = index->height;
+    ggit_bitset_resize(out_commits, height);
+
+    if (filter->since || filter->until) {
+        int64_t const until = filter->until ? filter->until : INT64_MAX;
+        int const from = lower_bound(index->times, height, filter->since);
+        int const to = until == INT64_MAX ? height
+                                          : lower_bound(index->times, height, until + 1);
+        for (int i = from; i < to; ++i)
+            ggit_bitset_set(out_commits, index->by_time[i]);
+    } else {
+        ggit_bitset_set_range(out_commits, 0, height);
+    }
+
+    if (filter->author[0]) {
+        struct ggit_bitset authored;
+        ggit_bitset_init(&authored);
+        ggit_bitset_resize(&authored, height);
+
+        for (int a = 0; a < index->n_authors; ++a) {
+            if (!contains_nocase(ggit_intern_string(&graph->authors, a), filter->author))
+                continue;
+            for (int i = index->author_offsets[a]; i < index->author_offsets[a + 1]; ++i)
+                ggit_bitset_set(&authored, index->author_commits[i]);
+        }
+        ggit_bitset_and(out_commits, &authored);
+        ggit_bitset_destroy(&authored);
+    }
+}
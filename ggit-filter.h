@@ -0,0 +1,51 @@
+#pragma once
+
+#include "ggit-bitset.h"
+#include "ggit-graph.h"
+
+#include <stdint.h>
+
+/* Which commits to show. Unset fields don't filter anything. */
+struct ggit_filter
+{
+    /* Commit time range, unix seconds, both inclusive. 0 = open ended. */
+    int64_t since;
+    int64_t until;
+
+    /* Case-insensitive substring of the author name. Empty = anyone. */
+    char author[64];
+};
+
+/** Indices over the graph metadata, built once per load.
+ *
+ * Applying a filter only walks the commits it keeps - a binary search into the
+ * time-sorted commits and the posting lists of the matching authors.
+ */
+struct ggit_filter_index
+{
+    int revision;
+    int height;
+
+    /* Commits sorted by commit time, and their times in the same order. */
+    int* by_time;
+    int64_t* times;
+
+    /* NOTE(boz):
+        Posting lists - the commits of author a are
+        author_commits[author_offsets[a] .. author_offsets[a + 1]), oldest first.
+    */
+    int n_authors;
+    int* author_offsets;
+    int* author_commits;
+};
+
+// clang-format off
+void   ggit_filter_index_init        (struct ggit_filter_index* index);
+void   ggit_filter_index_destroy     (struct ggit_filter_index* index);
+void   ggit_filter_index_build       (struct ggit_filter_index* index, struct ggit_graph const* graph);
+size_t ggit_filter_index_memory_usage(struct ggit_filter_index const* index);
+
+bool ggit_filter_is_empty(struct ggit_filter const* filter);
+bool ggit_filter_parse   (struct ggit_filter* filter, char const* text);
+void ggit_filter_apply   (struct ggit_filter_index const* index, struct ggit_graph const* graph, struct ggit_filter const* filter, struct ggit_bitset* out_commits);
+// clang-format on
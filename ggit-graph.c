@@ -1,6 +1,7 @@
 #include "ggit-graph.h"
 #include "ggit-vector.h"
 
+#include <ctype.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
@@ -9,9 +10,16 @@
 
 #include <libsmallregex.h>
 
+/* Between the fields of a log line - `%x1f` in the pretty format, never part of a name. */
+#define GGIT_LOG_FIELD_SEPARATOR '\x1f'
 
-GGIT_GENERATE_VECTOR_REF_GETTER(struct ggit_commit_parents, commit_parents)
-GGIT_GENERATE_VECTOR_REF_GETTER(struct ggit_commit_tag, commit_tags)
+/* Where the space separated parent hashes of a commit are in the log, until they get resolved. */
+struct ggit_parent_hashes
+{
+    size_t offset;
+    int length;
+};
+GGIT_TYPED_VECTOR(parent_hashes, struct ggit_parent_hashes)
 
 
 static bool
@@ -20,61 +28,42 @@ starts_with(char const* restrict str, char const* restrict prefix)
     return strncmp(str, prefix, strlen(prefix)) == 0;
 }
 
-static int
-index_of(int str_len, char const* str, char c)
-{
-    for (int i = 0; i < str_len; ++i) {
-        if (str[i] == c)
-            return i;
-    }
-    return -1;
-}
-
-static char*
-strndup(int length, char const* text)
-{
-    char* dst = (char*)calloc(length + 1, 1);
-    memcpy(dst, text, length);
-    return dst;
-}
-
 
 static bool
 ggit_run(
     char const* restrict command,
     char** restrict out_stdout,
-    int* restrict out_stdout_length
+    size_t* restrict out_stdout_length
 )
 {
-    struct ggit_vector buf_stdout = { 0 };
-    ggit_vector_init(&buf_stdout, sizeof(char));
-    ggit_vector_reserve(&buf_stdout, 4096);
+    struct ggit_vec_char buf_stdout;
+    ggit_vec_char_init(&buf_stdout);
+    ggit_vec_char_reserve(&buf_stdout, 4096);
 
     FILE* pipe = _popen(command, "r");
     if (!pipe)
         return false;
 
     while (true) {
-        char* begin = (char*)buf_stdout.data;
         size_t read = fread(
-            begin + buf_stdout.size,
+            buf_stdout.data + buf_stdout.size,
             1,
             buf_stdout.capacity - buf_stdout.size,
             pipe
         );
         if (read == 0) {
             /* NOTE(boz): Put the null terminator */
-            ggit_vector_push(&buf_stdout, &read);
+            ggit_vec_char_push(&buf_stdout, '\0');
             break;
         }
-        buf_stdout.size += (int)read;
+        buf_stdout.size += read;
         if (buf_stdout.size == buf_stdout.capacity)
-            ggit_vector_reserve_more(&buf_stdout, buf_stdout.capacity);
+            ggit_vec_char_reserve(&buf_stdout, buf_stdout.capacity + 1);
     }
     fclose(pipe);
 
     if (out_stdout)
-        *out_stdout = (char*)buf_stdout.data;
+        *out_stdout = buf_stdout.data;
     else
         free(buf_stdout.data);
     if (out_stdout_length)
@@ -83,16 +72,27 @@ ggit_run(
 }
 static int
 ggit_load_refs(
-    int refs_len,
+    size_t refs_len,
     char* restrict refs,
+    struct ggit_arena* restrict arena,
     struct ggit_vector* restrict ref_names,
     struct ggit_vector* restrict ref_hashes
 )
 {
-    int start_hash = 0;
-    int start_name = 0;
+    /* NOTE(boz):
+        The vectors are in the arena too - sized up front, so the names allocated
+        in between don't make them move (and leave their old copies behind).
+    */
+    int lines = 0;
+    for (size_t i = 0; i < refs_len; ++i)
+        lines += refs[i] == '\n';
+    ggit_vector_reserve(ref_names, lines);
+    ggit_vector_reserve(ref_hashes, lines);
+
+    size_t start_hash = 0;
+    size_t start_name = 0;
     int n = 0;
-    for (int i = 0; i < refs_len; ++i) {
+    for (size_t i = 0; i < refs_len; ++i) {
         switch (refs[i]) {
             case ' ':
                 ggit_vector_push(ref_hashes, refs + start_hash);
@@ -100,7 +100,7 @@ ggit_load_refs(
                 break;
             case '\0': break;
             case '\n':
-                char* name = strndup(i - start_name, refs + start_name);
+                char* name = ggit_arena_strndup(arena, refs + start_name, i - start_name);
                 ggit_vector_push(ref_names, &name);
                 start_hash = i + 1;
                 ++n;
@@ -111,340 +111,345 @@ ggit_load_refs(
 }
 
 
-static bool
-ggit_parse_merge_commit__bitbucket_0(
-    int message_length,
-    char const* merge_commit_message,
-    char** out_name_main,
-    char** out_name_kink
-)
+/* NOTE(boz):
+    Hash index - the commits sorted by hash, with the first 16 hex digits of every
+    hash packed into a uint64 (first digit in the top nibble). Prefix lookups are a
+    binary search over the keys, the strings are only read to confirm the match.
+*/
+struct ggit_hash_entry
 {
-    /* Like: Merged in build/update-installer-output-paths (pull request #287) */
-
-    char const start_0[] = "Merged in ";
-    int start_0_strlen = sizeof(start_0) - 1;
-    if (!starts_with(merge_commit_message, start_0))
-        /* Not a bitbucket merge */
-        return false;
-
-    int next_space = index_of(
-        message_length - start_0_strlen,
-        merge_commit_message + start_0_strlen,
-        ' '
-    );
-    int open_paren = index_of(
-        message_length - start_0_strlen,
-        merge_commit_message + start_0_strlen,
-        '('
-    );
-
-    int end = (min(open_paren, next_space)) - 1;
+    uint64_t key;
+    int commit;
+};
 
-    if (next_space <= 0 && open_paren <= 0)
-        return false;
-
-    *out_name_main = 0;
-    *out_name_kink = strndup(next_space, merge_commit_message + start_0_strlen);
-    return true;
+static int
+ggit_hex_digit(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
 }
-static bool
-ggit_parse_merge_commit__bitbucket_1(
-    int message_length,
-    char const* merge_commit_message,
-    char** out_name_main,
-    char** out_name_kink
-)
+/* Packs up to 16 hex digits, -1 in *out_digits if a character isn't one. */
+static uint64_t
+ggit_hash_key(char const* hash, int length, int* out_digits)
 {
-    /* Like: Merged A into B (pull request #287) */
-
-    char const start_0[] = "Merged ";
-    int start_0_strlen = sizeof(start_0) - 1;
-    if (!starts_with(merge_commit_message, start_0))
-        /* Not a bitbucket merge */
-        return false;
-
-    int next_space = index_of(
-        message_length - start_0_strlen,
-        merge_commit_message + start_0_strlen,
-        ' '
-    );
-
-    if (next_space <= 0)
-        return false;
-
-    char const* kink_name = merge_commit_message + start_0_strlen;
-    int kink_strlen = next_space;
-
-    if (0 != memcmp(kink_name + kink_strlen, " into ", 6))
-        return false;
-
-    char const* main_name = kink_name + kink_strlen + 6;
-    int main_strlen = message_length - start_0_strlen - 6 - kink_strlen;
-    next_space = index_of(main_strlen, main_name, ' ');
-    if (next_space > 0) {
-        main_strlen = next_space;
-    } else {
-        int open_paren = index_of(main_strlen, main_name, '(');
-        if (open_paren > 0) {
-            main_strlen = open_paren;
+    uint64_t key = 0;
+    int const digits = min(length, 16);
+    for (int i = 0; i < digits; ++i) {
+        int const d = ggit_hex_digit(hash[i]);
+        if (d == -1) {
+            *out_digits = -1;
+            return 0;
         }
+        key |= (uint64_t)d << (60 - 4 * i);
     }
-
-    *out_name_main = strndup(main_strlen, main_name);
-    *out_name_kink = strndup(kink_strlen, kink_name);
-    return true;
+    *out_digits = digits;
+    return key;
 }
-
-/* TODO:
-    clean up the internals
-*/
-static bool
-ggit_parse_merge_commit__git_local(
-    int message_length,
-    char const* merge_commit_message,
-    char** out_name_main,
-    char** out_name_kink
-)
+static int
+ggit_hash_entry_compare(void const* a, void const* b)
 {
-    /* NOTE(boz):
-        Original regex:
-        "Merge branch '(.+?)'(?: into (.+))?"
-    */
-    static char const start_0[] = "Merge branch '";
-    int start_0_strlen = sizeof(start_0) - 1;
-    if (!starts_with(merge_commit_message, start_0))
-        return false;
-
-    // NOTE(boz): GIT's default merge message when merging into master.
-    int closing_quote = index_of(
-        message_length - start_0_strlen,
-        merge_commit_message + start_0_strlen,
-        '\''
+    struct ggit_hash_entry const* ea = (struct ggit_hash_entry const*)a;
+    struct ggit_hash_entry const* eb = (struct ggit_hash_entry const*)b;
+    if (ea->key != eb->key)
+        return ea->key < eb->key ? -1 : 1;
+    return ea->commit - eb->commit;
+}
+static void
+ggit_build_hash_index(struct ggit_graph* graph, int count, char* const* hashes)
+{
+    struct ggit_hash_entry* entries = (struct ggit_hash_entry*)malloc(
+        max(count, 1) * sizeof(struct ggit_hash_entry)
     );
-    if (closing_quote > 0) {
-        int kink_len = closing_quote;
-        char* kink_name = strndup(kink_len, merge_commit_message + start_0_strlen);
-        if (closing_quote + start_0_strlen + 1 != message_length) {
-            // into 'branch_main'
-            char const* leftover_message = merge_commit_message + start_0_strlen
-                                           + closing_quote + 1;
-            char const* main_name;
-            if (starts_with(leftover_message, " into ")) {
-                main_name = leftover_message + 6;
-            } else {
-                main_name = "master";
-            }
-            *out_name_main = _strdup(main_name);
-        } else {
-            *out_name_main = _strdup("master");
-        }
-        *out_name_kink = kink_name;
-    } else {
-        return false;
+    graph->hash_keys = (uint64_t*)malloc(max(count, 1) * sizeof(uint64_t));
+    graph->hash_commits = (int*)malloc(max(count, 1) * sizeof(int));
+    if (!entries || !graph->hash_keys || !graph->hash_commits) {
+        perror("[ggit_build_hash_index] OOM.");
+        abort();
     }
-    return true;
+
+    for (int c = 0; c < count; ++c) {
+        int digits;
+        entries[c].key = ggit_hash_key(hashes[c], (int)strlen(hashes[c]), &digits);
+        entries[c].commit = c;
+    }
+    qsort(entries, count, sizeof(*entries), ggit_hash_entry_compare);
+    for (int i = 0; i < count; ++i) {
+        graph->hash_keys[i] = entries[i].key;
+        graph->hash_commits[i] = entries[i].commit;
+    }
+    free(entries);
 }
+/* Either one is a prefix of the other - `hash` abbreviated, or `text` being short. */
 static bool
-ggit_parse_merge_commit__git_remote(
-    int message_length,
-    char const* merge_commit_message,
-    char** out_name_main,
-    char** out_name_kink
+ggit_hash_matches(char const* hash, char const* text, int length)
+{
+    int i = 0;
+    while (i < length && hash[i] && tolower((unsigned char)text[i]) == hash[i])
+        ++i;
+    return i == length || !hash[i];
+}
+/** Commit of the (possibly abbreviated) hash in `text`.
+ *
+ * -1 if no commit matches, -2 if the prefix is ambiguous. O(log n).
+ */
+static int
+ggit_find_commit(
+    uint64_t const* keys,
+    int const* commits,
+    char* const* hashes,
+    int count,
+    char const* text,
+    int length
 )
 {
-    /* NOTE(boz):
-        Original regex:
-        "Merge remote-tracking branch 'origin/(.+?)'(?: into (.+))?"
-    */
-    static char const start_0[] = "Merge remote-tracking branch '";
-    int start_0_strlen = sizeof(start_0) - 1;
-    if (!starts_with(merge_commit_message, start_0))
-        return false;
+    int digits;
+    uint64_t const key = ggit_hash_key(text, length, &digits);
+    if (digits <= 0)
+        return -1;
+    uint64_t const span = digits == 16 ? 0 : (~(uint64_t)0 >> (4 * digits));
+
+    // First key >= key.
+    int lo = 0;
+    int hi = count;
+    while (lo < hi) {
+        int const mid = lo + (hi - lo) / 2;
+        if (keys[mid] < key)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
 
-    /* TODO: implement. */
-    return false;
+    int found = -1;
+    for (int i = lo; i < count && keys[i] <= (key | span); ++i) {
+        if (!ggit_hash_matches(hashes[commits[i]], text, length))
+            continue;
+        if (found != -1)
+            return -2;
+        found = commits[i];
+    }
+    /* An abbreviated hash shorter than the text sorts right before it. */
+    if (found == -1 && lo > 0 && ggit_hash_matches(hashes[commits[lo - 1]], text, length))
+        found = commits[lo - 1];
+    return found;
 }
-static bool
-ggit_parse_merge_commit(
-    int message_length,
-    char const* merge_commit_message,
-    char** out_name_main,
-    char** out_name_kink
-)
+int
+ggit_graph_find_commit(struct ggit_graph const* graph, char const* text, int length)
 {
-    return ggit_parse_merge_commit__git_local(
-               message_length,
-               merge_commit_message,
-               out_name_main,
-               out_name_kink
-           )
-           || ggit_parse_merge_commit__git_remote(
-               message_length,
-               merge_commit_message,
-               out_name_main,
-               out_name_kink
-           )
-           || ggit_parse_merge_commit__bitbucket_0(
-               message_length,
-               merge_commit_message,
-               out_name_main,
-               out_name_kink
-           )
-           || ggit_parse_merge_commit__bitbucket_1(
-               message_length,
-               merge_commit_message,
-               out_name_main,
-               out_name_kink
-           )
-           || 0;
+    return ggit_find_commit(
+        graph->hash_keys,
+        graph->hash_commits,
+        graph->hashes,
+        graph->height,
+        text,
+        length
+    );
 }
 
 static int
 ggit_match_refs_to_commits(
+    struct ggit_graph const* restrict graph,
     struct ggit_vector* restrict ref_hashes,
-    struct ggit_vector* restrict commit_hashes,
+    struct ggit_vec_string const* restrict commit_hashes,
     struct ggit_vector* restrict out_ref_commits
 )
 {
     int count_refs = ref_hashes->size;
-    int count_commits = commit_hashes->size;
+    ggit_vector_reserve(out_ref_commits, count_refs);
     for (int r = 0; r < count_refs; ++r) {
-        bool found = false;
         char* ref_hash = ggit_vector_get(ref_hashes, r);
-
-        for (int c = 0; c < count_commits; ++c) {
-            char* commit_hash = ggit_vector_get_string(commit_hashes, c);
-            int commit_hash_len = (int)strlen(commit_hash);
-
-            if (0 == strncmp(commit_hash, ref_hash, commit_hash_len)) {
-                ggit_vector_push(out_ref_commits, &c);
-                found = true;
-                break;
-            }
-        }
-        if (!found) {
-            int commit = -1;
-            ggit_vector_push(out_ref_commits, &commit);
-        }
+        int commit = ggit_find_commit(
+            graph->hash_keys,
+            graph->hash_commits,
+            commit_hashes->data,
+            (int)commit_hashes->size,
+            ref_hash,
+            40
+        );
+        commit = max(commit, -1);
+        ggit_vector_push(out_ref_commits, &commit);
     }
 
     return 0;
 }
-struct ggit_commit_tag
-ggit_branch_to_tag(char const* ref_name, struct ggit_vector* special_branches)
+/** Classifies the branch names interned since the last call, all of them in one batch.
+ *
+ * Every name goes through the classifier once per load. Instances are handed out
+ * in the order the names were first seen - refs first, then merges, oldest first.
+ */
+static void
+ggit_branch_names_classify(
+    struct ggit_branch_names* restrict names,
+    struct ggit_vector* restrict special_branches,
+    struct ggit_classifier const* restrict classifier
+)
 {
-    struct ggit_commit_tag tag = { { -1, -1 }, true };
-    if (strcmp(ref_name, "HEAD") == 0)
-        goto end;
-
-    for (int i = 0; i < special_branches->size; ++i) {
-        struct ggit_special_branch* sb = ggit_vector_ref_special_branch(
-            special_branches,
-            i
-        );
-
-        if (regex_matchp(sb->regex, ref_name) == 0) {
-            int n_instances = sb->instances.size;
-            tag.tag[0] = i;
-            for (int j = 0; j < n_instances; ++j) {
-                char* instance_name = ggit_vector_get_string(&sb->instances, j);
+    int const first = names->tags.size;
+    int const count = ggit_intern_count(&names->names) - first;
+    if (count <= 0)
+        return;
+
+    char const** texts = (char const**)malloc(count * sizeof(char const*));
+    int* lengths = (int*)malloc(count * sizeof(int));
+    int* branches = (int*)malloc(count * sizeof(int));
+    if (!texts || !lengths || !branches) {
+        perror("[ggit_branch_names_classify] OOM.");
+        abort();
+    }
+    for (int i = 0; i < count; ++i) {
+        texts[i] = ggit_intern_string(&names->names, first + i);
+        lengths[i] = (int)strlen(texts[i]);
+    }
+    ggit_classifier_match_batch(classifier, count, texts, lengths, branches);
+
+    for (int i = 0; i < count; ++i) {
+        struct ggit_commit_tag tag = { { -1, -1 }, true };
+        if (branches[i] != -1 && strcmp(texts[i], "HEAD") != 0) {
+            struct ggit_special_branch* sb = ggit_vector_ref_special_branch(
+                special_branches,
+                branches[i]
+            );
+            tag.tag[0] = branches[i];
+            tag.tag[1] = sb->instances.size;
+            /* NOTE(boz): The interned names stay put until the instances are cleared with them. */
+            ggit_vector_push(&sb->instances, &texts[i]);
+        }
+        if (tag.tag[0] == -1)
+            fprintf(stderr, "Ignoring ref %s - no matching special branches.\n", texts[i]);
+        ggit_vector_push(&names->tags, &tag);
+    }
 
-                if (0 == strcmp(ref_name, instance_name)) {
-                    tag.tag[1] = j;
-                    break;
-                }
-            }
+    free(texts);
+    free(lengths);
+    free(branches);
+}
+static struct ggit_commit_tag
+ggit_branch_names_tag(struct ggit_branch_names const* names, int id)
+{
+    if (id == -1)
+        return (struct ggit_commit_tag){ { -1, -1 }, false };
+    assert(id < names->tags.size);
+    return ((struct ggit_commit_tag const*)names->tags.data)[id];
+}
 
-            if (tag.tag[1] == -1) {
-                tag.tag[1] = n_instances;
-                char* sub_name = _strdup(ref_name);
-                ggit_vector_push(&sb->instances, &sub_name);
-            }
-            break;
+/* Interns the branch a ref name points at, -1 if it isn't one we know. */
+static int
+ggit_refname_to_name(struct ggit_branch_names* names, char const* ref_name)
+{
+    static char const* const prefixes[] = {
+        "refs/heads/",
+        "refs/remotes/origin/",
+        "refs/stash",
+        "refs/tags/",
+    };
+    /* TODO: support git tags and other things. */
+    for (int i = 0; i < (int)(sizeof(prefixes) / sizeof(*prefixes)); ++i) {
+        if (starts_with(ref_name, prefixes[i])) {
+            char const* name = ref_name + strlen(prefixes[i]);
+            return ggit_intern_add(&names->names, name, (int)strlen(name));
         }
     }
-end:
-    if (tag.tag[0] == -1)
-        fprintf(stderr, "Ignoring ref %s - no matching special branches.\n", ref_name);
-    return tag;
+    return -1;
 }
 
-static struct ggit_commit_tag
-ggit_refname_to_tag(char const* ref_name, struct ggit_vector* special_branches)
+static int
+ggit_merge_name_intern(struct ggit_branch_names* names, struct ggit_merge_name name)
 {
-    char const prefix_local_branch[] = "refs/heads/";
-    char const prefix_stash[] = "refs/stash";
-    char const prefix_tags[] = "refs/tags/";
-    char const prefix_remote_branch[] = "refs/remotes/origin/";
-    /* TODO: support git tags and other things. */
-    if (starts_with(ref_name, prefix_local_branch))
-        return ggit_branch_to_tag(
-            ref_name + sizeof(prefix_local_branch) - 1,
-            special_branches
-        );
-    else if (starts_with(ref_name, prefix_remote_branch))
-        return ggit_branch_to_tag(
-            ref_name + sizeof(prefix_remote_branch) - 1,
-            special_branches
-        );
-    else if (starts_with(ref_name, prefix_stash))
-        return ggit_branch_to_tag(
-            ref_name + sizeof(prefix_stash) - 1,
-            special_branches
-        );
-    else if (starts_with(ref_name, prefix_tags))
-        return ggit_branch_to_tag(ref_name + sizeof(prefix_tags) - 1, special_branches);
-    return (struct ggit_commit_tag){ { -1, -1 }, false };
+    if (!name.text)
+        return -1;
+    return ggit_intern_add(&names->names, name.text, name.length);
 }
+/** Recognizes the merge messages, interning the branch names they mention.
+ *
+ * For every merge commit, oldest first, `out_merge_names` gets the number of names
+ * and then the ids - main first (-1 if there's none), then the merged branches.
+ */
+static void
+ggit_collect_merge_names(
+    int const* restrict commit_message_lengths,
+    char* const* restrict commit_messages,
+    struct ggit_parents const* restrict commit_parents,
+    struct ggit_merge_patterns const* restrict merge_patterns,
+    struct ggit_branch_names* restrict branch_names,
+    struct ggit_vector* restrict out_merge_names
+)
+{
+    int count = commit_parents->count;
+    int n_merges = 0;
+    int n_recognized = 0;
+    clock_t const start = clock();
+
+    for (int c = 0; c < count; ++c) {
+        int const n_parents = ggit_parents_count(commit_parents, c);
+        if (n_parents < 2)
+            // One parent -> ignore the commit.
+            continue;
+
+        int msg_len = commit_message_lengths[c];
+        char const* msg = commit_messages[c];
+
+        struct ggit_merge_match match = { 0 };
+        n_recognized += ggit_merge_match(merge_patterns, msg_len, msg, &match);
+        ++n_merges;
+
+        // Names of parents the merge doesn't have are left out.
+        int const n_kinks = min(match.n_kinks, n_parents - 1);
+        int const n_names = 1 + n_kinks;
+        ggit_vector_push(out_merge_names, &n_names);
+        int const id_main = ggit_merge_name_intern(branch_names, match.main);
+        ggit_vector_push(out_merge_names, &id_main);
+        for (int k = 0; k < n_kinks; ++k) {
+            int const id_kink = ggit_merge_name_intern(branch_names, match.kinks[k]);
+            ggit_vector_push(out_merge_names, &id_kink);
+        }
+    }
 
+    printf(
+        "Recognizing merges took %.2fms (%d of %d messages)\n",
+        1000.0 * (clock() - start) / CLOCKS_PER_SEC,
+        n_recognized,
+        n_merges
+    );
+}
 static int
 ggit_label_merge_commits(
-    struct ggit_vector* restrict commit_message_lengths,
-    struct ggit_vector* restrict commit_messages,
-    struct ggit_vector* restrict commit_parents,
-    struct ggit_vector* restrict commit_tags,
-    struct ggit_vector* restrict special_branches
+    struct ggit_parents const* restrict commit_parents,
+    struct ggit_commit_tag* restrict commit_tags,
+    struct ggit_vector const* restrict merge_names,
+    struct ggit_branch_names const* restrict branch_names
 )
 {
-    int count = commit_message_lengths->size;
+    int count = commit_parents->count;
     int width = 0;
+    int const* names = (int const*)merge_names->data;
 
     for (int c = 0; c < count; ++c) {
-        int const* my_parents = ggit_vector_ref_commit_parents(commit_parents, c)
-                                    ->parent;
-        if (my_parents[1] == -1)
+        int n_parents;
+        int const* my_parents = ggit_parents_of(commit_parents, c, &n_parents);
+        if (n_parents < 2)
             // One parent -> ignore the commit.
             continue;
 
-        /* NOTE(boz): has 2 parents -> merge commit. */
-        /* PERF(boz):
-            Unoptimized. A 'cache-miss' just to get the length of a message?
-            Measure if strlen() is faster on average in this case.
+        /* NOTE(boz):
+            2+ parents -> merge commit. The message names the merged branches, an
+            octopus' parents without a name are left to tag propagation.
         */
+        int const n_names = *names++;
+        int const* ids = names;
+        names += n_names;
 
-        int msg_len = ggit_vector_get_int(commit_message_lengths, c);
-        char const* msg = ggit_vector_get_string(commit_messages, c);
-
-        char* name_main = 0;
-        char* name_kink = 0;
-        ggit_parse_merge_commit(msg_len, msg, &name_main, &name_kink);
-
-        struct ggit_commit_tag tag_main = { { -1, -1 }, false };
+        struct ggit_commit_tag tag_main = ggit_branch_names_tag(branch_names, ids[0]);
         struct ggit_commit_tag tag_kink = { { -1, -1 }, false };
-        if (name_main)
-            tag_main = ggit_branch_to_tag(name_main, special_branches);
-        if (name_kink)
-            tag_kink = ggit_branch_to_tag(name_kink, special_branches);
-
-        struct ggit_commit_tag* my_tags = ggit_vector_ref_commit_tags(commit_tags, c);
-        struct ggit_commit_tag* p0_tags = ggit_vector_ref_commit_tags(
-            commit_tags,
-            my_parents[0]
-        );
-        struct ggit_commit_tag* p1_tags = ggit_vector_ref_commit_tags(
-            commit_tags,
-            my_parents[1]
-        );
+        if (n_names > 1)
+            tag_kink = ggit_branch_names_tag(branch_names, ids[1]);
+
+        struct ggit_commit_tag* my_tags = commit_tags + c;
+        struct ggit_commit_tag* p0_tags = commit_tags + my_parents[0];
+        struct ggit_commit_tag* p1_tags = commit_tags + my_parents[1];
 
         if (tag_main.tag[0] == -1)
             tag_main = *my_tags;
@@ -452,53 +457,179 @@ ggit_label_merge_commits(
         *my_tags = *p0_tags = tag_main;
         *p1_tags = tag_kink;
 
-        free(name_main);
-        free(name_kink);
-
         width = max(tag_main.tag[0], width);
         width = max(tag_kink.tag[0], width);
+
+        for (int k = 2; k < n_names; ++k) {
+            struct ggit_commit_tag const tag = ggit_branch_names_tag(branch_names, ids[k]);
+            if (tag.tag[0] == -1)
+                continue;
+            commit_tags[my_parents[k]] = tag;
+            width = max(tag.tag[0], width);
+        }
     }
     return width;
 }
+static inline void
+ggit_propagate_tag(struct ggit_commit_tag const* my_tags, struct ggit_commit_tag* p0_tags)
+{
+    if (p0_tags->strong) {
+        return;
+    } else {
+        if (p0_tags->tag[0] == -1 || p0_tags->tag[0] > my_tags->tag[0]) {
+            *p0_tags = *my_tags;
+            p0_tags->strong = false;
+        }
+    }
+}
 /** Take commits with tags and recursively tag the parents of the commits, according to
  * some rules.
  *
  * Initially (in ggit_graph_init), only branch-heads are tagged with their respective
  * tags. This function tags all the parents of those commits, recursively, applying the
  * left-right rule (or main-kink rule).
+ *
+ * Goes chain by chain, newest first - the same commit order as one by one, but inside
+ * of a chain the first parent is the commit right before, no need to look it up.
  */
 static void
 ggit_propagate_tags(
-    struct ggit_vector* restrict commit_parents,
-    struct ggit_vector* restrict commit_tags
+    struct ggit_parents const* restrict commit_parents,
+    int n_chains,
+    int const* restrict chain_starts,
+    struct ggit_commit_tag* restrict commit_tags
 )
 {
-    int count = commit_parents->size;
-    assert(commit_tags->size == count);
-    for (int c = count - 1; c >= 0; --c) {
-        int const my_parent = ggit_vector_ref_commit_parents(commit_parents, c)
-                                  ->parent[0];
-        if (my_parent != -1) {
-            struct ggit_commit_tag const* my_tags = ggit_vector_ref_commit_tags(
-                commit_tags,
-                c
-            );
-            struct ggit_commit_tag* p0_tags = ggit_vector_ref_commit_tags(
-                commit_tags,
-                my_parent
-            );
-            if (p0_tags->strong) {
-                continue;
-            } else {
-                if (p0_tags->tag[0] == -1 || p0_tags->tag[0] > my_tags->tag[0]) {
-                    *p0_tags = *my_tags;
-                    p0_tags->strong = false;
-                }
-            }
-        }
+    for (int ch = n_chains - 1; ch >= 0; --ch) {
+        int const begin = chain_starts[ch];
+        for (int c = chain_starts[ch + 1] - 1; c > begin; --c)
+            ggit_propagate_tag(commit_tags + c, commit_tags + c - 1);
+
+        int const my_parent = ggit_parents_first(commit_parents, begin);
+        if (my_parent != -1)
+            ggit_propagate_tag(commit_tags + begin, commit_tags + my_parent);
     }
 }
 
+/** generation[c] - 1 for root commits, one more than the highest parent otherwise.
+ *
+ * Nothing with a generation <= g can reach a commit of generation g (except itself),
+ * which is what lets ancestry walks stop early.
+ */
+static int*
+ggit_compute_generations(struct ggit_parents const* parents)
+{
+    int const count = parents->count;
+    int* generations = (int*)malloc(max(count, 1) * sizeof(int));
+    if (!generations) {
+        perror("[ggit_compute_generations] OOM.");
+        abort();
+    }
+    for (int c = 0; c < count; ++c) {
+        int generation = 0;
+        int n_parents;
+        int const* my_parents = ggit_parents_of(parents, c, &n_parents);
+        for (int j = 0; j < n_parents; ++j)
+            generation = max(generation, generations[my_parents[j]]);
+        generations[c] = generation + 1;
+    }
+    return generations;
+}
+/** Splits the commits into first-parent chains, stored as their starts (+ count at the end).
+ *
+ * A chain is a maximal run of commits where the first parent of every commit is
+ * the commit right before it - linear history, as long as nothing else got
+ * committed in between.
+ */
+static int*
+ggit_compute_chains(struct ggit_parents const* parents, int* out_n_chains)
+{
+    int const count = parents->count;
+    int* starts = (int*)malloc((count + 1) * sizeof(int));
+    if (!starts) {
+        perror("[ggit_compute_chains] OOM.");
+        abort();
+    }
+    int n = 0;
+    for (int c = 0; c < count; ++c) {
+        if (c == 0 || ggit_parents_first(parents, c) != c - 1)
+            starts[n++] = c;
+    }
+    starts[n] = count;
+    *out_n_chains = n;
+    return starts;
+}
+/** Inverts the parent edges into a CSR index - child_offsets has count + 1 entries.
+ *
+ * Children are filled in by walking the commits oldest first, so every list comes
+ * out sorted. One int per edge, one per commit, no per-commit allocations.
+ */
+static void
+ggit_compute_children(
+    struct ggit_parents const* parents,
+    int** out_child_offsets,
+    int** out_children
+)
+{
+    int const count = parents->count;
+    int const* all = parents->parents.data;
+    int* offsets = (int*)calloc(count + 1, sizeof(int));
+    if (!offsets) {
+        perror("[ggit_compute_children] OOM.");
+        abort();
+    }
+    for (size_t e = 0; e < parents->parents.size; ++e)
+        offsets[all[e] + 1] += 1;
+    for (int c = 0; c < count; ++c)
+        offsets[c + 1] += offsets[c];
+
+    int* children = (int*)malloc(max(offsets[count], 1) * sizeof(int));
+    if (!children) {
+        perror("[ggit_compute_children] OOM.");
+        abort();
+    }
+
+    /* NOTE(boz):
+        Fill using offsets[parent] as the cursor, which leaves every entry
+        pointing at the end of its list - shift them back afterwards.
+    */
+    for (int c = 0; c < count; ++c) {
+        int n_parents;
+        int const* my_parents = ggit_parents_of(parents, c, &n_parents);
+        for (int j = 0; j < n_parents; ++j)
+            children[offsets[my_parents[j]]++] = c;
+    }
+    for (int c = count; c > 0; --c)
+        offsets[c] = offsets[c - 1];
+    offsets[0] = 0;
+
+    *out_child_offsets = offsets;
+    *out_children = children;
+}
+/** reach[c] - the newest commit with an edge into any of the commits 0..c. */
+int*
+ggit_compute_reach(struct ggit_parents const* parents)
+{
+    int const count = parents->count;
+    int* reach = (int*)malloc(max(count, 1) * sizeof(int));
+    if (!reach) {
+        perror("[ggit_compute_reach] OOM.");
+        abort();
+    }
+    for (int c = 0; c < count; ++c)
+        reach[c] = c;
+
+    for (int c = 0; c < count; ++c) {
+        int n_parents;
+        int const* my_parents = ggit_parents_of(parents, c, &n_parents);
+        for (int j = 0; j < n_parents; ++j)
+            reach[my_parents[j]] = max(reach[my_parents[j]], c);
+    }
+    for (int c = 1; c < count; ++c)
+        reach[c] = max(reach[c], reach[c - 1]);
+    return reach;
+}
+
 static void
 expand_span_merges(struct ggit_column_span* span, int i)
 {
@@ -512,6 +643,28 @@ expand_span_commits(struct ggit_column_span* span, int i)
     span->commit_min = min(span->commit_min, i);
     expand_span_merges(span, i);
 }
+/* Span of the instance, 0 for untagged commits. */
+static struct ggit_column_span*
+ggit_tag_span(struct ggit_graph* graph, struct ggit_commit_tag tag)
+{
+    if (tag.tag[0] == -1)
+        return 0;
+    struct ggit_special_branch* sb = ggit_vector_ref_special_branch(
+        &graph->special_branches,
+        tag.tag[0]
+    );
+    return ggit_vector_ref_column_span(&sb->spans, tag.tag[1]);
+}
+/* An edge from commit i (in `span`) to `parent` - both spans reach over it. */
+static void
+expand_span_edge(struct ggit_graph* graph, struct ggit_column_span* span, int i, int parent)
+{
+    if (span)
+        expand_span_merges(span, parent);
+    struct ggit_column_span* p_span = ggit_tag_span(graph, graph->tags[parent]);
+    if (p_span)
+        expand_span_merges(p_span, i);
+}
 void
 ggit_compute_column_spans(struct ggit_graph* graph)
 {
@@ -534,215 +687,540 @@ ggit_compute_column_spans(struct ggit_graph* graph)
         }
     }
 
+    /* NOTE(boz):
+        Chain by chain, in runs of commits of the same instance. Every expansion is
+        a min/max, so a run only needs its ends and the edge coming into it - the
+        first parent edges inside of it stay inside of the run.
+    */
+    struct ggit_commit_tag const* tags = graph->tags;
+    for (int ch = 0; ch < graph->n_chains; ++ch) {
+        int const begin = graph->chain_starts[ch];
+        int const end = graph->chain_starts[ch + 1];
+        for (int lo = begin; lo < end;) {
+            struct ggit_commit_tag const tag = tags[lo];
+            int hi = lo;
+            while (hi + 1 < end && tags[hi + 1].tag[0] == tag.tag[0]
+                   && tags[hi + 1].tag[1] == tag.tag[1])
+                ++hi;
+
+            struct ggit_column_span* span = ggit_tag_span(graph, tag);
+            if (span) {
+                expand_span_commits(span, lo);
+                expand_span_commits(span, hi);
+            }
+            int const parent = lo > begin ? lo - 1 : ggit_parents_first(&graph->parents, lo);
+            if (parent != -1)
+                expand_span_edge(graph, span, lo, parent);
+            lo = hi + 1;
+        }
+    }
+
+    // The other parents of merges.
     for (int i = 0; i < graph->height; ++i) {
-        struct ggit_commit_tag tag = graph->tags[i];
-        struct ggit_commit_parents parents = graph->parents[i];
+        int n_parents;
+        int const* parents = ggit_parents_of(&graph->parents, i, &n_parents);
+        if (n_parents < 2)
+            continue;
+        struct ggit_column_span* span = ggit_tag_span(graph, tags[i]);
+        for (int j = 1; j < n_parents; ++j)
+            expand_span_edge(graph, span, i, parents[j]);
+    }
 
+    for (int i = 0; i < graph->special_branches.size; ++i) {
         struct ggit_special_branch* sb = ggit_vector_ref_special_branch(
             &graph->special_branches,
-            tag.tag[0]
+            i
         );
-        struct ggit_column_span* span = ggit_vector_ref_column_span(
-            &sb->spans,
-            tag.tag[1]
+        ggit_span_index_build(
+            &sb->span_index,
+            sb->spans.size,
+            (struct ggit_column_span const*)sb->spans.data,
+            sb->growth_direction >= 0
+        );
+    }
+}
+
+/** Refs grouped by the commit they point at, in one counting sort over ref_commits.
+ *
+ * Rows on screen are a contiguous run of commits, so the labels to draw are the
+ * slices of those commits and nothing else.
+ */
+static void
+ggit_compute_commit_refs(struct ggit_graph* graph)
+{
+    int const count = graph->height;
+    int const n_refs = graph->ref_commits.size;
+    int* offsets = (int*)calloc(count + 1, sizeof(int));
+    int* refs = (int*)malloc(max(n_refs, 1) * sizeof(int));
+    if (!offsets || !refs) {
+        perror("[ggit_compute_commit_refs] OOM.");
+        abort();
+    }
+    for (int r = 0; r < n_refs; ++r) {
+        int const commit = ggit_vector_get_int(&graph->ref_commits, r);
+        if (commit != -1)
+            offsets[commit + 1] += 1;
+    }
+    for (int c = 0; c < count; ++c)
+        offsets[c + 1] += offsets[c];
+    for (int r = 0; r < n_refs; ++r) {
+        int const commit = ggit_vector_get_int(&graph->ref_commits, r);
+        if (commit != -1)
+            refs[offsets[commit]++] = r;
+    }
+    for (int c = count; c > 0; --c)
+        offsets[c] = offsets[c - 1];
+    offsets[0] = 0;
+
+    graph->commit_ref_offsets = offsets;
+    graph->commit_refs = refs;
+}
+/** Groups the commits by branch instance - (tag[0], tag[1]) - in one counting sort.
+ *
+ * Instances are numbered branch after branch, see ggit_graph_instance. Commits are
+ * visited oldest first, so every member list comes out sorted.
+ */
+static void
+ggit_compute_instance_members(struct ggit_graph* graph)
+{
+    int const n_branches = graph->special_branches.size;
+    int* base = (int*)malloc((n_branches + 1) * sizeof(int));
+    if (!base) {
+        perror("[ggit_compute_instance_members] OOM.");
+        abort();
+    }
+    base[0] = 0;
+    for (int i = 0; i < n_branches; ++i) {
+        struct ggit_special_branch const* sb = ggit_vector_ref_special_branch(
+            &graph->special_branches,
+            i
+        );
+        base[i + 1] = base[i] + sb->instances.size;
+    }
+    int const n_instances = base[n_branches];
+
+    int* offsets = (int*)calloc(n_instances + 1, sizeof(int));
+    int* members = (int*)malloc(max(graph->height, 1) * sizeof(int));
+    if (!offsets || !members) {
+        perror("[ggit_compute_instance_members] OOM.");
+        abort();
+    }
+    for (int c = 0; c < graph->height; ++c) {
+        struct ggit_commit_tag const tag = graph->tags[c];
+        if (tag.tag[0] != -1)
+            offsets[base[tag.tag[0]] + tag.tag[1] + 1] += 1;
+    }
+    for (int i = 0; i < n_instances; ++i)
+        offsets[i + 1] += offsets[i];
+    for (int c = 0; c < graph->height; ++c) {
+        struct ggit_commit_tag const tag = graph->tags[c];
+        if (tag.tag[0] != -1)
+            members[offsets[base[tag.tag[0]] + tag.tag[1]]++] = c;
+    }
+    for (int i = n_instances; i > 0; --i)
+        offsets[i] = offsets[i - 1];
+    offsets[0] = 0;
+
+    graph->n_instances = n_instances;
+    graph->instance_base = base;
+    graph->instance_offsets = offsets;
+    graph->instance_members = members;
+}
+/* The special branches might have changed since the last load. */
+static void
+ggit_graph_build_classifier(struct ggit_graph* graph)
+{
+    int const count = graph->special_branches.size;
+    char const** patterns = (char const**)malloc(max(count, 1) * sizeof(char const*));
+    struct small_regex** regexes = (struct small_regex**)malloc(
+        max(count, 1) * sizeof(struct small_regex*)
+    );
+    if (!patterns || !regexes) {
+        perror("[ggit_graph_build_classifier] OOM.");
+        abort();
+    }
+    for (int i = 0; i < count; ++i) {
+        struct ggit_special_branch* sb = ggit_vector_ref_special_branch(
+            &graph->special_branches,
+            i
+        );
+        patterns[i] = sb->pattern;
+        regexes[i] = sb->regex;
+    }
+    ggit_classifier_build(&graph->classifier, count, patterns, regexes);
+    free(patterns);
+    free(regexes);
+}
+/* Drops everything ggit_graph_relabel derives, the loaded commits stay. */
+static void
+ggit_graph_clear_labels(struct ggit_graph* graph)
+{
+    free(graph->tags);
+    graph->tags = 0;
+    free(graph->instance_base);
+    free(graph->instance_offsets);
+    free(graph->instance_members);
+    graph->n_instances = 0;
+    graph->instance_base = 0;
+    graph->instance_offsets = 0;
+    graph->instance_members = 0;
+    graph->width = 0;
+
+    /* NOTE(boz): The instances go away with the names, so does what they were tagged with. */
+    ggit_intern_clear(&graph->branch_names.names);
+    ggit_vector_clear(&graph->branch_names.tags);
+    for (int i = 0; i < graph->special_branches.size; ++i) {
+        ggit_special_branch_clear(
+            ggit_vector_ref_special_branch(&graph->special_branches, i)
         );
-        expand_span_commits(span, i);
-
-        for (int j = 0; j < 2; ++j) {
-            int const parent = parents.parent[j];
-
-            if (parent != -1) {
-                expand_span_merges(span, parent);
-
-                struct ggit_commit_tag p_tag = graph->tags[parent];
-
-                if (p_tag.tag[0] != -1) {
-                    struct ggit_special_branch* p_sb = ggit_vector_ref_special_branch(
-                        &graph->special_branches,
-                        p_tag.tag[0]
-                    );
-                    struct ggit_column_span* p_span = ggit_vector_ref_column_span(
-                        &p_sb->spans,
-                        p_tag.tag[1]
-                    );
-                    expand_span_merges(p_span, i);
-                }
-            }
-        }
     }
 }
+/** Tags the commits, then lays the branches out - everything that depends on the
+ * special branches and the merge patterns.
+ *
+ * Reads only the topology, the refs and the messages, so after the branch config
+ * changes this redoes the layout without going back to git. Bumps the revision.
+ */
+void
+ggit_graph_relabel(struct ggit_graph* graph)
+{
+    clock_t const start = clock();
+    ggit_graph_clear_labels(graph);
+
+    int const count = graph->height;
+    graph->tags = (struct ggit_commit_tag*)malloc(
+        max(count, 1) * sizeof(struct ggit_commit_tag)
+    );
+    if (!graph->tags) {
+        perror("[ggit_graph_relabel] OOM.");
+        abort();
+    }
+    for (int c = 0; c < count; ++c)
+        graph->tags[c] = (struct ggit_commit_tag){ { -1, -1 }, false };
+
+    /* NOTE(boz):
+        Every branch name the refs and the merge messages mention gets interned
+        first, so they're all classified in one go.
+    */
+    ggit_graph_build_classifier(graph);
+    int const n_refs = graph->ref_commits.size;
+    int* ref_name_ids = (int*)malloc(max(n_refs, 1) * sizeof(int));
+    if (!ref_name_ids) {
+        perror("[ggit_graph_relabel] OOM.");
+        abort();
+    }
+    for (int i = 0; i < n_refs; ++i) {
+        char* ref_name = ggit_vector_get_string(&graph->ref_names, i);
+        int index = ggit_vector_get_i32(&graph->ref_commits, i);
+        ref_name_ids[i] = index == -1 ? -1
+                                      : ggit_refname_to_name(&graph->branch_names, ref_name);
+    }
+    struct ggit_vector merge_names;
+    ggit_vector_init(&merge_names, sizeof(int));
+    ggit_collect_merge_names(
+        graph->message_lengths,
+        graph->messages,
+        &graph->parents,
+        &graph->merge_patterns,
+        &graph->branch_names,
+        &merge_names
+    );
+    ggit_branch_names_classify(
+        &graph->branch_names,
+        &graph->special_branches,
+        &graph->classifier
+    );
 
+    int w0 = 0;
+    for (int i = 0; i < n_refs; ++i) {
+        int index = ggit_vector_get_i32(&graph->ref_commits, i);
+        if (index == -1)
+            continue;
+        struct ggit_commit_tag* tags = graph->tags + index;
+
+        struct ggit_commit_tag ref_tag = ggit_branch_names_tag(
+            &graph->branch_names,
+            ref_name_ids[i]
+        );
+        if (ref_tag.tag[0] != -1) {
+            *tags = ref_tag;
+        }
+        w0 = max(ref_tag.tag[0], w0);
+    }
+    free(ref_name_ids);
+    int w1 = ggit_label_merge_commits(
+        &graph->parents,
+        graph->tags,
+        &merge_names,
+        &graph->branch_names
+    );
+    ggit_vector_destroy(&merge_names);
+    ggit_propagate_tags(&graph->parents, graph->n_chains, graph->chain_starts, graph->tags);
+    graph->width = max(w0, w1);
+    graph->width = 0;
+    for (int i = 0; i < graph->special_branches.size; ++i) {
+        struct ggit_special_branch* branch = ggit_vector_ref_special_branch(
+            &graph->special_branches,
+            i
+        );
+        graph->width += branch->instances.size;
+    }
+
+    ggit_compute_column_spans(graph);
+    ggit_compute_instance_members(graph);
+    graph->revision += 1;
+    printf("Labeling took %.2fms\n", 1000.0 * (clock() - start) / CLOCKS_PER_SEC);
+}
 
-#define GGIT_VECTOR_DEFINE(name, type, initial_size) \
-    struct ggit_vector name;                         \
-    ggit_vector_init(&name, sizeof(type));           \
-    ggit_vector_reserve(&name, (initial_size));
 
 static int
 ggit_graph_load_repository(
-    int gitlog_len,
+    size_t gitlog_len,
     char* gitlog,
-    int refs_len,
+    size_t refs_len,
     char* refs,
     struct ggit_graph* out_graph
 )
 {
-    int const heuristic_refs = 512;
-    int const heuristic_commits = 4096;
+    size_t const heuristic_commits = 4096;
 
     ggit_graph_clear(out_graph);
 
-    GGIT_VECTOR_DEFINE(commit_messages, char*, heuristic_commits);
-    GGIT_VECTOR_DEFINE(commit_message_lengths, int, heuristic_commits);
+    struct ggit_vec_string commit_messages;
+    struct ggit_vec_int commit_message_lengths;
+    /* NOTE(boz):
+        All subjects back to back, each one NUL terminated - so a search is one
+        linear scan instead of a pointer chase per commit.
+    */
+    struct ggit_vec_char message_store;
     /* TODO: change to char[40] */
-    GGIT_VECTOR_DEFINE(commit_hashes, char*, heuristic_commits);
-    GGIT_VECTOR_DEFINE(commit_parents, struct ggit_commit_parents, heuristic_commits);
-    GGIT_VECTOR_DEFINE(commit_tags, struct ggit_commit_tag, heuristic_commits);
-
-    ggit_load_refs(refs_len, refs, &out_graph->ref_names, &out_graph->ref_hashes);
+    struct ggit_vec_string commit_hashes;
+    struct ggit_vec_parent_hashes commit_parent_hashes;
+    struct ggit_vec_int commit_authors;
+    struct ggit_vec_i64 commit_author_times;
+    struct ggit_vec_i64 commit_commit_times;
+    ggit_vec_string_init(&commit_messages);
+    ggit_vec_int_init(&commit_message_lengths);
+    ggit_vec_char_init(&message_store);
+    ggit_vec_string_init(&commit_hashes);
+    ggit_vec_parent_hashes_init(&commit_parent_hashes);
+    ggit_vec_int_init(&commit_authors);
+    ggit_vec_i64_init(&commit_author_times);
+    ggit_vec_i64_init(&commit_commit_times);
+    ggit_vec_int_reserve(&commit_message_lengths, heuristic_commits);
+    ggit_vec_char_reserve(&message_store, heuristic_commits * 64);
+    ggit_vec_string_reserve(&commit_hashes, heuristic_commits);
+    ggit_vec_parent_hashes_reserve(&commit_parent_hashes, heuristic_commits);
+    ggit_vec_int_reserve(&commit_authors, heuristic_commits);
+    ggit_vec_i64_reserve(&commit_author_times, heuristic_commits);
+    ggit_vec_i64_reserve(&commit_commit_times, heuristic_commits);
+
+    ggit_load_refs(
+        refs_len,
+        refs,
+        &out_graph->arena,
+        &out_graph->ref_names,
+        &out_graph->ref_hashes
+    );
 
-    int last_pipe = -1;
+    size_t field_begin = 0;
     int n = 0;
-    int parts[8];
+    size_t parts[12];
     /* NOTE(boz):
-        Structure of logs:
-            COMMIT_HASH|PARENT_0_HASH PARENT_1_HASH|COMMIT_MESSAGE_SUBJECT
+        Structure of logs (fields split by the unit separator 0x1F, shown as |):
+            COMMIT_HASH|PARENT_HASHES|AUTHOR_TIME|COMMIT_TIME|AUTHOR|SUBJECT
 
         Example:
-            4b9a43a|bae4937 7862c77|code2            <- 2 parents commit
-            bae4937|7862c77|code                     <- 1 parent  commit
-            7862c77|45a8e25|progress: Git graph.     <- 1 parent  commit
-            45a8e25||z: Initial commit               <- 0 parents commit
+            4b9a43a|bae4937 7862c77|1700000300|1700000300|boz|code2   <- 2 parents commit
+            bae4937|7862c77|1700000200|1700000200|boz|code            <- 1 parent  commit
+            7862c77|45a8e25|1700000100|1700000150|boz|progress: Git graph.
+            45a8e25||1700000000|1700000000|boz|z: Initial commit      <- 0 parents commit
+
+        Octopus merges just list more parents. Author names can hold a '|', so
+        the fields are split on a control character instead. The subject is
+        last, so a stray separator inside of it is just text.
     */
-    for (int i = 0; i < gitlog_len; ++i) {
+    int const part_subject = 5;
+    size_t const arena_before_hashes = out_graph->arena.used;
+    for (size_t i = 0; i < gitlog_len; ++i) {
         switch (gitlog[i]) {
-            case '|':
-                parts[2 * n] = last_pipe + 1;
+            case GGIT_LOG_FIELD_SEPARATOR:
+                if (n == part_subject)
+                    break;
+                parts[2 * n] = field_begin;
                 parts[2 * n + 1] = i;
-                last_pipe = i;
-                if (n == 1) {
-                    n += 1;
-                    /* NOTE(boz):
-                        Single-parent commit, fill the missing parent.
-                    */
-                    parts[2 * n] = i;
-                    parts[2 * n + 1] = i;
-                }
+                field_begin = i + 1;
                 n += 1;
                 break;
-            case ' ':
-                if (n == 1) {
-                    parts[2 * n] = last_pipe + 1;
-                    parts[2 * n + 1] = i;
-                    last_pipe = i;
-                    ++n;
-                }
-                break;
             case '\0':
             case '\n': {
-                parts[2 * n] = last_pipe + 1;
+                parts[2 * n] = field_begin;
                 parts[2 * n + 1] = i;
-                last_pipe = i;
+                field_begin = i + 1;
                 n = 0;
 
-                int p0_len = parts[3] - parts[2];
-                int p1_len = parts[5] - parts[4];
-                char const* p0_hash = gitlog + parts[2];
-                char const* p1_hash = gitlog + parts[4];
-
-                struct ggit_commit_parents parents = { -1, -1 };
-                /* PERF(boz):
-                    THIS IS VERY SLOW!!!
-                    Implement a hashmap to MASSIVELY speed this up.
-                */
-                for (int p = commit_hashes.size - 1; p >= 0; --p) {
-                    char* commit_hash = ggit_vector_get_string(&commit_hashes, p);
-                    if (parents.parent[0] == -1 && p0_len
-                        && 0 == strncmp(commit_hash, p0_hash, p0_len)) {
-                        parents.parent[0] = p;
-                        if (!p1_len || parents.parent[1] != -1)
-                            break;
-                    } else if (parents.parent[1] == -1 && p1_len && 0 == strncmp(commit_hash, p1_hash, p1_len)) {
-                        parents.parent[1] = p;
-                        if (!p0_len || parents.parent[0] != -1)
-                            break;
-                    }
-                }
-                ggit_vector_push(&commit_parents, &parents);
-
-                int msg_len = parts[7] - parts[6];
-                char* msg = strndup(msg_len, gitlog + parts[6]);
-                char* hash = strndup(parts[1] - parts[0], gitlog + parts[0]);
-                ggit_vector_push(&commit_message_lengths, &msg_len);
-                ggit_vector_push(&commit_messages, &msg);
-                ggit_vector_push(&commit_hashes, &hash);
-                struct ggit_commit_tag tags = { { -1, -1 }, false };
-                ggit_vector_push(&commit_tags, &tags);
+                /* Resolved once all hashes are known and indexed. */
+                struct ggit_parent_hashes parent_hashes = {
+                    parts[2],
+                    (int)(parts[3] - parts[2]),
+                };
+                ggit_vec_parent_hashes_push(&commit_parent_hashes, parent_hashes);
+
+                int64_t const author_time = strtoll(gitlog + parts[4], 0, 10);
+                int64_t const commit_time = strtoll(gitlog + parts[6], 0, 10);
+                int const author = ggit_intern_add(
+                    &out_graph->authors,
+                    gitlog + parts[8],
+                    (int)(parts[9] - parts[8])
+                );
+                ggit_vec_i64_push(&commit_author_times, author_time);
+                ggit_vec_i64_push(&commit_commit_times, commit_time);
+                ggit_vec_int_push(&commit_authors, author);
+
+                int msg_len = (int)(parts[11] - parts[10]);
+                char* msg = ggit_vec_char_extend(&message_store, (size_t)msg_len + 1);
+                memcpy(msg, gitlog + parts[10], msg_len);
+                msg[msg_len] = '\0';
+
+                char* hash = ggit_arena_strndup(
+                    &out_graph->arena,
+                    gitlog + parts[0],
+                    parts[1] - parts[0]
+                );
+                ggit_vec_int_push(&commit_message_lengths, msg_len);
+                ggit_vec_string_push(&commit_hashes, hash);
+            }
+        }
+    }
+
+    out_graph->hash_bytes = out_graph->arena.used - arena_before_hashes;
+
+    /* The store moved while growing (and shrinking), point into it only now. */
+    ggit_vec_char_shrink(&message_store);
+    /* Rows keep 32 bit offsets into the store (ggit_row::message_offset). */
+    assert(message_store.size <= UINT32_MAX && "subjects over 4GiB don't fit a row's offset");
+    ggit_vec_string_reserve(&commit_messages, commit_message_lengths.size);
+    size_t offset = 0;
+    for (size_t c = 0; c < commit_message_lengths.size; ++c) {
+        ggit_vec_string_push(&commit_messages, message_store.data + offset);
+        offset += (size_t)commit_message_lengths.data[c] + 1;
+    }
+
+    int const count = (int)commit_hashes.size;
+    ggit_build_hash_index(out_graph, count, commit_hashes.data);
+    /* NOTE(boz):
+        Parents missing from the log (shallow clones) are left out, so
+        every stored parent is a valid commit.
+    */
+    struct ggit_parents* commit_parents = &out_graph->parents;
+    /* One more parent than spaces in every non-empty %p, so the array is allocated once. */
+    size_t edges = 0;
+    for (int c = 0; c < count; ++c) {
+        struct ggit_parent_hashes const* hashes = commit_parent_hashes.data + c;
+        char const* text = gitlog + hashes->offset;
+        edges += hashes->length > 0;
+        for (int i = 0; i < hashes->length; ++i)
+            edges += text[i] == ' ';
+    }
+    ggit_parents_reserve(commit_parents, count, (int)edges);
+    for (int c = 0; c < count; ++c) {
+        struct ggit_parent_hashes const* hashes = commit_parent_hashes.data + c;
+        char const* text = gitlog + hashes->offset;
+        char const* const text_end = text + hashes->length;
+        while (text < text_end) {
+            int length = 0;
+            while (text + length < text_end && text[length] != ' ')
+                ++length;
+            if (length) {
+                int const parent = ggit_find_commit(
+                    out_graph->hash_keys,
+                    out_graph->hash_commits,
+                    commit_hashes.data,
+                    count,
+                    text,
+                    length
+                );
+                if (parent >= 0)
+                    ggit_vec_int_push(&commit_parents->parents, parent);
             }
+            text += length + 1;
         }
+        ggit_parents_end_commit(commit_parents);
     }
+    /* NOTE(boz): Parents a shallow clone doesn't have were counted but not stored. */
+    ggit_vec_int_shrink(&commit_parents->parents);
+    ggit_vec_parent_hashes_destroy(&commit_parent_hashes);
 
     ggit_match_refs_to_commits(
+        out_graph,
         &out_graph->ref_hashes,
         &commit_hashes,
         &out_graph->ref_commits
     );
-    int w0 = 0;
-    for (int i = 0; i < out_graph->ref_commits.size; ++i) {
-        char* ref_name = ggit_vector_get_string(&out_graph->ref_names, i);
-        int index = ggit_vector_get_i32(&out_graph->ref_commits, i);
-        if (index == -1)
-            continue;
-        struct ggit_commit_tag* tags = ggit_vector_ref_commit_tags(&commit_tags, index);
-
-        struct ggit_commit_tag ref_tag = ggit_refname_to_tag(
-            ref_name,
-            &out_graph->special_branches
-        );
-        if (ref_tag.tag[0] != -1) {
-            *tags = ref_tag;
-        }
-        w0 = max(ref_tag.tag[0], w0);
-    }
-    int w1 = ggit_label_merge_commits(
-        &commit_message_lengths,
-        &commit_messages,
-        &commit_parents,
-        &commit_tags,
-        &out_graph->special_branches
+    /* NOTE(boz):
+        The vectors were sized from a guess and grew 1.5x, the graph keeps them for
+        good - shrunk, n elements is what they hold, and what the memory report says.
+    */
+    ggit_vec_string_shrink(&commit_hashes);
+    ggit_vec_int_shrink(&commit_message_lengths);
+    ggit_vec_string_shrink(&commit_messages);
+    ggit_vec_int_shrink(&commit_authors);
+    ggit_vec_i64_shrink(&commit_author_times);
+    ggit_vec_i64_shrink(&commit_commit_times);
+    out_graph->hashes = commit_hashes.data;
+    out_graph->message_lengths = commit_message_lengths.data;
+    out_graph->messages = commit_messages.data;
+    out_graph->message_store = message_store.data;
+    out_graph->message_store_size = message_store.size;
+    out_graph->author_ids = commit_authors.data;
+    out_graph->author_times = commit_author_times.data;
+    out_graph->commit_times = commit_commit_times.data;
+    out_graph->height = count;
+    out_graph->log_size = gitlog_len + refs_len;
+    out_graph->generations = ggit_compute_generations(&out_graph->parents);
+    out_graph->chain_starts = ggit_compute_chains(&out_graph->parents, &out_graph->n_chains);
+    ggit_compute_children(
+        &out_graph->parents,
+        &out_graph->child_offsets,
+        &out_graph->children
     );
-    ggit_propagate_tags(&commit_parents, &commit_tags);
-    out_graph->width = max(w0, w1);
-    out_graph->width = 0;
-    for (int i = 0; i < out_graph->special_branches.size; ++i) {
-        struct ggit_special_branch* branch = ggit_vector_ref_special_branch(
-            &out_graph->special_branches,
-            i
-        );
-        out_graph->width += branch->instances.size;
-    }
-
-    out_graph->hashes = (char**)commit_hashes.data;
-    out_graph->message_lengths = (int*)commit_message_lengths.data;
-    out_graph->parents = (struct ggit_commit_parents*)commit_parents.data;
-    out_graph->messages = (char**)commit_messages.data;
-    out_graph->tags = (struct ggit_commit_tag*)commit_tags.data;
-    out_graph->height = commit_messages.size;
+    out_graph->reach = ggit_compute_reach(&out_graph->parents);
+    ggit_compute_commit_refs(out_graph);
 
-    ggit_compute_column_spans(out_graph);
+    ggit_graph_relabel(out_graph);
     return 0;
 }
 
+static void
+ggit_special_branches_destroy(struct ggit_vector* special_branches)
+{
+    for (int i = 0; i < special_branches->size; ++i) {
+        struct ggit_special_branch* sb = ggit_vector_ref_special_branch(special_branches, i);
+        ggit_special_branch_clear(sb);
+        ggit_special_branch_destroy(sb);
+    }
+    ggit_vector_destroy(special_branches);
+}
+
 int
 ggit_graph_init(struct ggit_graph* graph)
 {
     memset(graph, 0, sizeof(*graph));
 
     ggit_vector_init(&graph->special_branches, sizeof(struct ggit_special_branch));
-
-    ggit_vector_init(&graph->ref_names, sizeof(char*));
-    ggit_vector_init(&graph->ref_hashes, sizeof(char[40]));
-    ggit_vector_init(&graph->ref_commits, sizeof(int));
+    ggit_intern_init(&graph->authors);
+    ggit_parents_init(&graph->parents);
+    ggit_merge_patterns_init(&graph->merge_patterns);
+    ggit_classifier_init(&graph->classifier);
+    ggit_intern_init(&graph->branch_names.names);
+    ggit_vector_init(&graph->branch_names.tags, sizeof(struct ggit_commit_tag));
+    ggit_merge_patterns_add_defaults(&graph->merge_patterns);
+
+    ggit_arena_init(&graph->arena);
+    graph->allocator = ggit_arena_allocator(&graph->arena);
+    ggit_vector_init_with(&graph->ref_names, sizeof(char*), &graph->allocator);
+    ggit_vector_init_with(&graph->ref_hashes, sizeof(char[40]), &graph->allocator);
+    ggit_vector_init_with(&graph->ref_commits, sizeof(int), &graph->allocator);
     return 0;
 }
 void
@@ -750,45 +1228,70 @@ ggit_graph_clear(struct ggit_graph* graph)
 {
     free(graph->message_lengths);
 
-    for (int i = 0; i < graph->height; ++i)
-        free(graph->messages[i]);
     free(graph->messages);
+    free(graph->message_store);
+    graph->message_store = 0;
+    graph->message_store_size = 0;
 
-    for (int i = 0; i < graph->height; ++i)
-        free(graph->hashes[i]);
     free(graph->hashes);
-
-    free(graph->parents);
-    free(graph->tags);
-
-    graph->width = 0;
+    graph->hash_bytes = 0;
+    graph->log_size = 0;
+
+    ggit_parents_clear(&graph->parents);
+    free(graph->generations);
+    graph->generations = 0;
+    free(graph->chain_starts);
+    graph->chain_starts = 0;
+    graph->n_chains = 0;
+    free(graph->child_offsets);
+    free(graph->children);
+    graph->child_offsets = 0;
+    graph->children = 0;
+    free(graph->commit_ref_offsets);
+    free(graph->commit_refs);
+    graph->commit_ref_offsets = 0;
+    graph->commit_refs = 0;
+    free(graph->reach);
+    graph->reach = 0;
+    free(graph->hash_keys);
+    free(graph->hash_commits);
+    graph->hash_keys = 0;
+    graph->hash_commits = 0;
+
+    free(graph->author_ids);
+    free(graph->author_times);
+    free(graph->commit_times);
+    graph->author_ids = 0;
+    graph->author_times = 0;
+    graph->commit_times = 0;
+    ggit_intern_clear(&graph->authors);
+
+    ggit_graph_clear_labels(graph);
     graph->height = 0;
 
-    for (int i = 0; i < graph->special_branches.size; ++i) {
-        ggit_special_branch_clear(
-            ggit_vector_ref_special_branch(&graph->special_branches, i)
-        );
-    }
-
-    ggit_vector_clear_and_free(&graph->ref_names);
-    ggit_vector_clear(&graph->ref_hashes);
-    ggit_vector_clear(&graph->ref_commits);
+    /* NOTE(boz): The hash strings, the ref names and the ref vectors all go with the arena. */
+    ggit_arena_reset(&graph->arena);
+    ggit_vector_init_with(&graph->ref_names, sizeof(char*), &graph->allocator);
+    ggit_vector_init_with(&graph->ref_hashes, sizeof(char[40]), &graph->allocator);
+    ggit_vector_init_with(&graph->ref_commits, sizeof(int), &graph->allocator);
 }
 void
 ggit_graph_destroy(struct ggit_graph* graph)
 {
     ggit_graph_clear(graph);
 
-    for (int i = 0; i < graph->special_branches.size; ++i) {
-        ggit_special_branch_destroy(
-            ggit_vector_ref_special_branch(&graph->special_branches, i)
-        );
-    }
-    ggit_vector_destroy(&graph->special_branches);
+    ggit_special_branches_destroy(&graph->special_branches);
+    ggit_intern_destroy(&graph->authors);
+    ggit_parents_destroy(&graph->parents);
+    ggit_merge_patterns_destroy(&graph->merge_patterns);
+    ggit_classifier_destroy(&graph->classifier);
+    ggit_intern_destroy(&graph->branch_names.names);
+    ggit_vector_destroy(&graph->branch_names.tags);
 
     ggit_vector_destroy(&graph->ref_names);
     ggit_vector_destroy(&graph->ref_hashes);
     ggit_vector_destroy(&graph->ref_commits);
+    ggit_arena_destroy(&graph->arena);
 }
 int
 ggit_graph_load(struct ggit_graph* graph, char const* path_repository)
@@ -801,7 +1304,8 @@ ggit_graph_load(struct ggit_graph* graph, char const* path_repository)
     sprintf_s(
         cmd_load_commits,
         sizeof(cmd_load_commits),
-        "git -C \"%s\" log --reverse --all --pretty=format:\"%%h|%%p|%%s\"",
+        "git -C \"%s\" log --reverse --all "
+        "--pretty=format:\"%%h%%x1f%%p%%x1f%%at%%x1f%%ct%%x1f%%an%%x1f%%s\"",
         path_repository
     );
     sprintf_s(
@@ -812,14 +1316,14 @@ ggit_graph_load(struct ggit_graph* graph, char const* path_repository)
     );
 
     char* gitlog;
-    int gitlog_len;
+    size_t gitlog_len;
     ggit_run(cmd_load_commits, &gitlog, &gitlog_len);
     took = time(0) - start;
     printf("Loading commits took %llds\n", took);
 
     start += took;
     char* refs;
-    int refs_len;
+    size_t refs_len;
     ggit_run(cmd_load_refs, &refs, &refs_len);
     took = time(0) - start;
     printf("Loading branches took %llds\n", took);
@@ -835,17 +1339,186 @@ ggit_graph_load(struct ggit_graph* graph, char const* path_repository)
     return 0;
 }
 
+/** Reads the special branches and extra merge formats from a config file.
+ *
+ *     # comment
+ *     branch <pattern> <growth: -1 | 0 | +1> <colour: RRGGBB> [name]
+ *     merge <pattern>
+ *
+ * Branches go highest priority first and replace the current ones, if the file has
+ * any. Merge formats are tried after the built-in ones, see ggit-merge.h.
+ * Nothing changes if the file is missing or a line doesn't parse, -1 then.
+ * A loaded graph keeps its old layout until ggit_graph_relabel.
+ */
+int
+ggit_graph_load_config(struct ggit_graph* graph, char const* path_config)
+{
+    FILE* file = fopen(path_config, "r");
+    if (!file)
+        return -1;
+
+    struct ggit_vector special_branches;
+    ggit_vector_init(&special_branches, sizeof(struct ggit_special_branch));
+    struct ggit_merge_patterns merge_patterns;
+    ggit_merge_patterns_init(&merge_patterns);
+    ggit_merge_patterns_add_defaults(&merge_patterns);
+
+    char line[1024];
+    int line_number = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), file)) {
+        ++line_number;
+        line[strcspn(line, "\r\n")] = '\0';
+        char* text = line;
+        while (isspace((unsigned char)*text))
+            ++text;
+        if (*text == '\0' || *text == '#')
+            continue;
+
+        if (starts_with(text, "merge ")) {
+            text += 6;
+            while (isspace((unsigned char)*text))
+                ++text;
+            ok = ggit_merge_patterns_add(&merge_patterns, text, 0);
+        } else if (starts_with(text, "branch ")) {
+            char pattern[256];
+            char name[256] = "";
+            int growth;
+            unsigned color;
+            int const n = sscanf(text + 7, "%255s %d %x %255s", pattern, &growth, &color, name);
+            ok = n >= 3 && growth >= -1 && growth <= 1 && color <= 0xFFFFFF;
+            if (ok) {
+                uint8_t const rgb[3] = { color >> 16, (color >> 8) & 0xFF, color & 0xFF };
+                ggit_special_branch_add(&special_branches, name, pattern, growth, rgb);
+                struct ggit_special_branch const* added = ggit_vector_ref_special_branch(
+                    &special_branches,
+                    special_branches.size - 1
+                );
+                ok = added->regex != 0;
+            }
+        } else {
+            ok = false;
+        }
+        if (!ok)
+            fprintf(stderr, "%s:%d: can't parse \"%s\".\n", path_config, line_number, line);
+    }
+    fclose(file);
+
+    if (!ok) {
+        ggit_special_branches_destroy(&special_branches);
+        ggit_merge_patterns_destroy(&merge_patterns);
+        return -1;
+    }
+    if (special_branches.size > 0) {
+        ggit_special_branches_destroy(&graph->special_branches);
+        graph->special_branches = special_branches;
+    } else {
+        ggit_vector_destroy(&special_branches);
+    }
+    ggit_merge_patterns_destroy(&graph->merge_patterns);
+    graph->merge_patterns = merge_patterns;
+    return 0;
+}
+
+/** Adds what the graph holds to the report, by tag. O(special branches). */
+void
+ggit_graph_memory_report(struct ggit_graph const* graph, struct ggit_memory_report* report)
+{
+    size_t* const bytes = report->bytes;
+    size_t const n = (size_t)graph->height;
+
+    bytes[ggit_memory_log] += graph->log_size;
+
+    bytes[ggit_memory_messages] += n * sizeof(*graph->message_lengths);
+    bytes[ggit_memory_messages] += n * sizeof(*graph->messages);
+    bytes[ggit_memory_messages] += graph->message_store_size;
+
+    bytes[ggit_memory_hashes] += n * sizeof(*graph->hashes);
+    bytes[ggit_memory_hashes] += n * sizeof(*graph->hash_keys);
+    bytes[ggit_memory_hashes] += n * sizeof(*graph->hash_commits);
+    bytes[ggit_memory_hashes] += graph->hash_bytes;
+
+    bytes[ggit_memory_parents] += ggit_parents_memory_usage(&graph->parents);
+    bytes[ggit_memory_parents] += n * sizeof(*graph->generations);
+    bytes[ggit_memory_parents] += n * sizeof(*graph->reach);
+    if (graph->chain_starts)
+        bytes[ggit_memory_parents] += (graph->n_chains + 1) * sizeof(*graph->chain_starts);
+    if (graph->child_offsets) {
+        bytes[ggit_memory_parents] += (n + 1) * sizeof(*graph->child_offsets);
+        bytes[ggit_memory_parents] += graph->child_offsets[n] * sizeof(*graph->children);
+    }
+
+    bytes[ggit_memory_tags] += n * sizeof(*graph->tags);
+    if (graph->instance_base) {
+        bytes[ggit_memory_tags] += (graph->special_branches.size + 1) * sizeof(*graph->instance_base);
+        bytes[ggit_memory_tags] += (graph->n_instances + 1) * sizeof(*graph->instance_offsets);
+        bytes[ggit_memory_tags] += n * sizeof(*graph->instance_members);
+    }
+    bytes[ggit_memory_tags] += ggit_merge_patterns_memory_usage(&graph->merge_patterns);
+    bytes[ggit_memory_tags] += ggit_classifier_memory_usage(&graph->classifier);
+    bytes[ggit_memory_tags] += ggit_intern_memory_usage(&graph->branch_names.names);
+    bytes[ggit_memory_tags] += ggit_vector_memory_usage(&graph->branch_names.tags);
+    for (int i = 0; i < graph->special_branches.size; ++i) {
+        struct ggit_special_branch const* sb = (struct ggit_special_branch const*)
+                                                   graph->special_branches.data
+                                               + i;
+        bytes[ggit_memory_tags] += ggit_vector_memory_usage(&sb->instances);
+        bytes[ggit_memory_spans] += ggit_vector_memory_usage(&sb->spans);
+        bytes[ggit_memory_spans] += ggit_span_index_memory_usage(&sb->span_index);
+    }
+
+    /* NOTE(boz): The arena is the hash strings and the refs, its slack goes with the refs. */
+    bytes[ggit_memory_refs] += ggit_arena_memory_usage(&graph->arena) - graph->hash_bytes;
+    if (graph->commit_ref_offsets) {
+        bytes[ggit_memory_refs] += (n + 1) * sizeof(*graph->commit_ref_offsets);
+        bytes[ggit_memory_refs] += graph->commit_ref_offsets[n] * sizeof(*graph->commit_refs);
+    }
+
+    bytes[ggit_memory_metadata] += n * sizeof(*graph->author_ids);
+    bytes[ggit_memory_metadata] += n * sizeof(*graph->author_times);
+    bytes[ggit_memory_metadata] += n * sizeof(*graph->commit_times);
+    bytes[ggit_memory_metadata] += ggit_intern_memory_usage(&graph->authors);
+}
+
+/** Adds a special branch, after (so with a lower priority than) the ones already there.
+ *
+ * `pattern` is a small-regex, matched against the start of the branch names.
+ */
+void
+ggit_special_branch_add(
+    struct ggit_vector* special_branches,
+    char const* name,
+    char const* pattern,
+    int8_t growth_direction,
+    uint8_t const color[3]
+)
+{
+    struct ggit_special_branch sb = {
+        .name = _strdup(name),
+        .pattern = _strdup(pattern),
+        .regex = regex_compile(pattern),
+        .growth_direction = growth_direction,
+        .colors_base = { [0] = { color[0], color[1], color[2] } },
+    };
+    ggit_vector_init(&sb.instances, sizeof(char*));
+    ggit_vector_init(&sb.spans, sizeof(struct ggit_column_span));
+    ggit_span_index_init(&sb.span_index);
+    ggit_vector_push(special_branches, &sb);
+}
 void
 ggit_special_branch_clear(struct ggit_special_branch* sb)
 {
-    ggit_vector_clear_and_free(&sb->instances);
+    ggit_vector_clear(&sb->instances);
     ggit_vector_clear(&sb->spans);
+    ggit_span_index_clear(&sb->span_index);
 }
 void
 ggit_special_branch_destroy(struct ggit_special_branch* sb)
 {
     free(sb->name);
+    free(sb->pattern);
     regex_free(sb->regex);
     ggit_vector_destroy(&sb->instances);
     ggit_vector_destroy(&sb->spans);
+    ggit_span_index_destroy(&sb->span_index);
 }
@@ -1,13 +1,16 @@
 #pragma once
 
+#include "ggit-classify.h"
+#include "ggit-intern.h"
+#include "ggit-memory.h"
+#include "ggit-merge.h"
+#include "ggit-parents.h"
+#include "ggit-spans.h"
 #include "ggit-vector.h"
 
-#include <libsmallregex.h>
+#include <stddef.h>
 
-struct ggit_commit_parents
-{
-    int parent[2];
-};
+#include <libsmallregex.h>
 
 struct ggit_commit_tag
 {
@@ -45,18 +48,12 @@ enum ggit_growth_direction
     ggit_growth_direction_right = 1,
 };
 
-struct ggit_column_span
-{
-    int merge_min;
-    int commit_min;
-    int commit_max;
-    int merge_max;
-};
-
 struct ggit_special_branch
 {
     /* Like: "release/" */
     char* name;
+    /* Like: "^release/" - regex source is kept for the combined classifier. */
+    char* pattern;
     struct small_regex* regex;
 
     /* Valid values:
@@ -68,8 +65,20 @@ struct ggit_special_branch
     /* Two colors, three bytes each (RGB). */
     uint8_t colors_base[2][3];
 
-    /* [char*]                   */ struct ggit_vector instances;
+    /* [char const*]             */ struct ggit_vector instances; /* names, in branch_names */
     /* [struct ggit_column_span] */ struct ggit_vector spans;
+    /* Spans packed into the branch's columns - left growing branches get one per instance. */
+    struct ggit_span_index span_index;
+};
+
+/* NOTE(boz):
+    Branch names met while tagging (refs and merge messages), interned.
+    tags[id] is what the name got classified as, the first time it showed up.
+*/
+struct ggit_branch_names
+{
+    struct ggit_intern names;
+    /* [struct ggit_commit_tag] */ struct ggit_vector tags;
 };
 
 struct ggit_graph
@@ -77,17 +86,80 @@ struct ggit_graph
     int width;
     int height;
 
+    /* Bumped on every (re)load, so derived caches know when to rebuild. */
+    int revision;
+
     int* message_lengths;
+    /* Point into message_store, where the subjects are stored back to back. */
     char** messages;
+    char* message_store;
+    size_t message_store_size;
     char** hashes;
-    struct ggit_commit_parents* parents;
+    /* Bytes of the hash strings, in the arena. */
+    size_t hash_bytes;
+    /* Bytes of git output the last load parsed - freed right after, kept for the memory report. */
+    size_t log_size;
+    struct ggit_parents parents;
+    /* NOTE(boz):
+        Everything small that lives exactly as long as one load - the hash strings,
+        the ref names and the ref vectors - comes from the arena (through allocator,
+        for the vectors), so clearing the graph frees a handful of blocks.
+    */
+    struct ggit_arena arena;
+    struct ggit_allocator allocator;
+    /* Topological generation - roots are 1, every commit is above all of its parents. */
+    int* generations;
+    /* First-parent chains - chain i is the commits chain_starts[i] .. chain_starts[i + 1],
+       every one of them having the commit before as its first parent. */
+    int n_chains;
+    int* chain_starts;
+    /* Children of c: children[child_offsets[c] .. child_offsets[c + 1]], oldest first. */
+    int* child_offsets;
+    int* children;
     struct ggit_commit_tag* tags;
 
-    struct ggit_vector special_branches;
+    /* NOTE(boz):
+        Per commit metadata, one array per field so filters only touch
+        the bytes they look at. Times are unix seconds.
+    */
+    int* author_ids;
+    int64_t* author_times;
+    int64_t* commit_times;
+    struct ggit_intern authors;
+
+    /* Commits sorted by hash, keyed by the first 16 hex digits. See ggit_graph_find_commit. */
+    uint64_t* hash_keys;
+    int* hash_commits;
+
+    /* NOTE(boz):
+        Branch instances - every (tag[0], tag[1]) pair - numbered branch after branch,
+        instance_base[tag[0]] + tag[1]. The commits of instance i are
+        instance_members[instance_offsets[i] .. instance_offsets[i + 1]], oldest first.
+    */
+    int n_instances;
+    int* instance_base;
+    int* instance_offsets;
+    int* instance_members;
+
+    /* reach[c] - the newest commit that has an edge into any of the commits 0..c.
+       Lets the renderer find the edges crossing a window of rows without a full scan. */
+    int* reach;
 
-    struct ggit_vector ref_names;
-    struct ggit_vector ref_hashes;
-    struct ggit_vector ref_commits;
+    struct ggit_vector special_branches;
+    /* Merge message formats - what names the branches of a merge commit. */
+    struct ggit_merge_patterns merge_patterns;
+    struct ggit_branch_names branch_names;
+    /* All special branch patterns in one DFA, rebuilt on every load. */
+    struct ggit_classifier classifier;
+
+    /* In the arena. */
+    /* [char*]    */ struct ggit_vector ref_names;
+    /* [char[40]] */ struct ggit_vector ref_hashes;
+    /* [int]      */ struct ggit_vector ref_commits;
+
+    /* Refs pointing at c: commit_refs[commit_ref_offsets[c] .. commit_ref_offsets[c + 1]]. */
+    int* commit_ref_offsets;
+    int* commit_refs;
 };
 
 // clang-format align
@@ -95,7 +167,50 @@ int ggit_graph_init(struct ggit_graph*);
 void ggit_graph_destroy(struct ggit_graph*);
 void ggit_graph_clear(struct ggit_graph*);
 int ggit_graph_load(struct ggit_graph*, char const* path_repository);
-
+int ggit_graph_load_config(struct ggit_graph*, char const* path_config);
+void ggit_graph_relabel(struct ggit_graph*);
+void ggit_graph_memory_report(struct ggit_graph const*, struct ggit_memory_report*);
+int ggit_graph_find_commit(struct ggit_graph const*, char const* hash, int length);
+int* ggit_compute_reach(struct ggit_parents const* parents);
+
+/* Children of the commit, oldest first. */
+static inline int const*
+ggit_graph_children(struct ggit_graph const* graph, int commit, int* out_count)
+{
+    int const begin = graph->child_offsets[commit];
+    *out_count = graph->child_offsets[commit + 1] - begin;
+    return graph->children + begin;
+}
+
+/* Indices (into ref_names) of the refs pointing at the commit. */
+static inline int const*
+ggit_graph_commit_refs(struct ggit_graph const* graph, int commit, int* out_count)
+{
+    int const begin = graph->commit_ref_offsets[commit];
+    *out_count = graph->commit_ref_offsets[commit + 1] - begin;
+    return graph->commit_refs + begin;
+}
+static inline int
+ggit_graph_instance(struct ggit_graph const* graph, struct ggit_commit_tag tag)
+{
+    return graph->instance_base[tag.tag[0]] + tag.tag[1];
+}
+/* Commits of the branch instance, oldest first. */
+static inline int const*
+ggit_graph_instance_members(struct ggit_graph const* graph, int instance, int* out_count)
+{
+    int const begin = graph->instance_offsets[instance];
+    *out_count = graph->instance_offsets[instance + 1] - begin;
+    return graph->instance_members + begin;
+}
+
+void ggit_special_branch_add(
+    struct ggit_vector* special_branches,
+    char const* name,
+    char const* pattern,
+    int8_t growth_direction,
+    uint8_t const color[3]
+);
 void ggit_special_branch_clear(struct ggit_special_branch*);
 void ggit_special_branch_destroy(struct ggit_special_branch*);
 
@@ -0,0 +1,126 @@
+#include "ggit-intern.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+/* FNV-1a */
+static uint32_t
+ggit_intern_hash(char const* text, int length)
+{
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < length; ++i) {
+        hash ^= (uint8_t)text[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+static bool
+ggit_intern_equals(struct ggit_intern const* intern, int id, char const* text, int length)
+{
+    char const* string = ggit_intern_string(intern, id);
+    return 0 == strncmp(string, text, length) && string[length] == '\0';
+}
+/* The slot holding `text`, or the empty slot where it would go. */
+static int
+ggit_intern_probe(struct ggit_intern const* intern, uint32_t hash, char const* text, int length)
+{
+    uint32_t const mask = (uint32_t)intern->slot_count - 1;
+    uint32_t const* hashes = (uint32_t const*)intern->hashes.data;
+
+    for (uint32_t slot = hash & mask;; slot = (slot + 1) & mask) {
+        int const id = intern->slots[slot];
+        if (id == -1)
+            return (int)slot;
+        if (hashes[id] == hash && ggit_intern_equals(intern, id, text, length))
+            return (int)slot;
+    }
+}
+static void
+ggit_intern_rehash(struct ggit_intern* intern, int slot_count)
+{
+    free(intern->slots);
+    intern->slots = (int*)malloc(slot_count * sizeof(int));
+    if (!intern->slots) {
+        perror("[ggit_intern_rehash] OOM.");
+        abort();
+    }
+    memset(intern->slots, 0xFF, slot_count * sizeof(int));
+    intern->slot_count = slot_count;
+
+    uint32_t const mask = (uint32_t)slot_count - 1;
+    uint32_t const* hashes = (uint32_t const*)intern->hashes.data;
+    for (int id = 0; id < intern->strings.size; ++id) {
+        uint32_t slot = hashes[id] & mask;
+        while (intern->slots[slot] != -1)
+            slot = (slot + 1) & mask;
+        intern->slots[slot] = id;
+    }
+}
+
+void
+ggit_intern_init(struct ggit_intern* intern)
+{
+    memset(intern, 0, sizeof(*intern));
+    ggit_vector_init(&intern->strings, sizeof(char*));
+    ggit_vector_init(&intern->hashes, sizeof(uint32_t));
+    ggit_arena_init(&intern->text);
+}
+void
+ggit_intern_destroy(struct ggit_intern* intern)
+{
+    ggit_vector_destroy(&intern->strings);
+    ggit_vector_destroy(&intern->hashes);
+    ggit_arena_destroy(&intern->text);
+    free(intern->slots);
+    memset(intern, 0, sizeof(*intern));
+}
+void
+ggit_intern_clear(struct ggit_intern* intern)
+{
+    ggit_vector_clear(&intern->strings);
+    ggit_vector_clear(&intern->hashes);
+    ggit_arena_reset(&intern->text);
+    if (intern->slots)
+        memset(intern->slots, 0xFF, intern->slot_count * sizeof(int));
+}
+/** The id of `text`, adding it if it's not in the table yet. */
+int
+ggit_intern_add(struct ggit_intern* intern, char const* text, int length)
+{
+    // Keep the load factor under 1/2.
+    if ((intern->strings.size + 1) * 2 > intern->slot_count)
+        ggit_intern_rehash(intern, intern->slot_count ? intern->slot_count * 2 : 64);
+
+    uint32_t const hash = ggit_intern_hash(text, length);
+    int const slot = ggit_intern_probe(intern, hash, text, length);
+    if (intern->slots[slot] != -1)
+        return intern->slots[slot];
+
+    int const id = intern->strings.size;
+    char* copy = ggit_arena_strndup(&intern->text, text, (size_t)length);
+    ggit_vector_push(&intern->strings, &copy);
+    ggit_vector_push(&intern->hashes, &hash);
+    intern->slots[slot] = id;
+    return id;
+}
+/** The id of `text`, or -1 if it was never added. */
+int
+ggit_intern_find(struct ggit_intern const* intern, char const* text, int length)
+{
+    if (!intern->slot_count)
+        return -1;
+    uint32_t const hash = ggit_intern_hash(text, length);
+    return intern->slots[ggit_intern_probe(intern, hash, text, length)];
+}
+size_t
+ggit_intern_memory_usage(struct ggit_intern const* intern)
+{
+    size_t total = 0;
+    total += (size_t)intern->strings.capacity * intern->strings.value_size;
+    total += (size_t)intern->hashes.capacity * intern->hashes.value_size;
+    total += (size_t)intern->slot_count * sizeof(int);
+    total += ggit_arena_memory_usage(&intern->text);
+    return total;
+}
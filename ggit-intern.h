@@ -0,0 +1,42 @@
+#pragma once
+
+#include "ggit-vector.h"
+
+#include <stddef.h>
+
+/** String -> small integer id table.
+ *
+ * Every distinct string is stored once, ids are handed out densely from 0 in the
+ * order the strings were first seen. The strings live in an arena, so they don't
+ * move while the table grows and clearing it is a free per block.
+ */
+struct ggit_intern
+{
+    /* [char*] */ struct ggit_vector strings;
+    struct ggit_arena text;
+    /* [uint32_t] */ struct ggit_vector hashes;
+
+    /* Open addressing, power of two sized, -1 = empty. */
+    int* slots;
+    int slot_count;
+};
+
+// clang-format off
+void   ggit_intern_init        (struct ggit_intern* intern);
+void   ggit_intern_destroy     (struct ggit_intern* intern);
+void   ggit_intern_clear       (struct ggit_intern* intern);
+int    ggit_intern_add         (struct ggit_intern* intern, char const* text, int length);
+int    ggit_intern_find        (struct ggit_intern const* intern, char const* text, int length);
+size_t ggit_intern_memory_usage(struct ggit_intern const* intern);
+// clang-format on
+
+static inline int
+ggit_intern_count(struct ggit_intern const* intern)
+{
+    return intern->strings.size;
+}
+static inline char const*
+ggit_intern_string(struct ggit_intern const* intern, int id)
+{
+    return ((char const* const*)intern->strings.data)[id];
+}
@@ -0,0 +1,194 @@
+#include "ggit-lod.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+static void*
+ggit_lod_alloc(size_t count, size_t size)
+{
+    void* block = calloc(count ? count : 1, size);
+    if (!block) {
+        perror("[ggit_lod_build] OOM.");
+        abort();
+    }
+    return block;
+}
+static void
+ggit_lod_cell_merge(struct ggit_lod_cell* restrict into, struct ggit_lod_cell const* from)
+{
+    into->commits += from->commits;
+    into->edge_min = min(into->edge_min, from->edge_min);
+    into->edge_max = max(into->edge_max, from->edge_max);
+}
+static void
+ggit_lod_level_init(
+    struct ggit_lod_level* level,
+    int bucket_rows,
+    int width,
+    int const* row_min,
+    int const* row_max
+)
+{
+    level->bucket_rows = bucket_rows;
+    level->first_bucket = (int*)ggit_lod_alloc(width, sizeof(int));
+    level->offsets = (int*)ggit_lod_alloc(width + 1, sizeof(int));
+
+    int n_cells = 0;
+    for (int k = 0; k < width; ++k) {
+        level->offsets[k] = n_cells;
+        if (row_min[k] > row_max[k])
+            continue;
+        level->first_bucket[k] = row_min[k] / bucket_rows;
+        n_cells += row_max[k] / bucket_rows - level->first_bucket[k] + 1;
+    }
+    level->offsets[width] = n_cells;
+
+    level->cells = (struct ggit_lod_cell*)ggit_lod_alloc(
+        n_cells,
+        sizeof(struct ggit_lod_cell)
+    );
+    for (int i = 0; i < n_cells; ++i) {
+        level->cells[i].edge_min = INT16_MAX;
+        level->cells[i].edge_max = INT16_MIN;
+    }
+}
+
+void
+ggit_lod_init(struct ggit_lod* lod)
+{
+    memset(lod, 0, sizeof(*lod));
+    lod->revision = -1;
+}
+void
+ggit_lod_destroy(struct ggit_lod* lod)
+{
+    for (int l = 0; l < lod->n_levels; ++l) {
+        free(lod->levels[l].first_bucket);
+        free(lod->levels[l].offsets);
+        free(lod->levels[l].cells);
+    }
+    free(lod->column_branch);
+    free(lod->row_min);
+    free(lod->row_max);
+    ggit_lod_init(lod);
+}
+/** Builds the pyramid from the raw column of every commit.
+ *
+ * Rows are the rows of the view (row 0 is the newest visible commit), same as the
+ * draw passes.
+ */
+void
+ggit_lod_build(
+    struct ggit_lod* lod,
+    struct ggit_graph const* graph,
+    struct ggit_view const* view,
+    int const* columns
+)
+{
+    ggit_lod_destroy(lod);
+
+    int const width = graph->width;
+    int const height = view->height;
+    lod->revision = view->serial;
+    lod->width = width;
+    lod->height = height;
+
+    lod->column_branch = (short*)ggit_lod_alloc(width, sizeof(short));
+    lod->row_min = (int*)ggit_lod_alloc(width, sizeof(int));
+    lod->row_max = (int*)ggit_lod_alloc(width, sizeof(int));
+    for (int k = 0; k < width; ++k) {
+        lod->column_branch[k] = -1;
+        lod->row_min[k] = INT32_MAX;
+        lod->row_max[k] = INT32_MIN;
+    }
+
+    for (int row = 0; row < height; ++row) {
+        int const commit_i = ggit_view_commit(view, row);
+        int const k = columns[commit_i];
+        lod->column_branch[k] = graph->tags[commit_i].tag[0];
+        lod->row_min[k] = min(lod->row_min[k], row);
+        lod->row_max[k] = max(lod->row_max[k], row);
+    }
+
+    // Finest level straight from the commits.
+    struct ggit_lod_level* level = &lod->levels[0];
+    ggit_lod_level_init(level, GGIT_LOD_BUCKET_ROWS, width, lod->row_min, lod->row_max);
+    lod->n_levels = 1;
+
+    for (int row = 0; row < height; ++row) {
+        int const commit_i = ggit_view_commit(view, row);
+        int const k = columns[commit_i];
+        struct ggit_lod_cell* cell = level->cells + level->offsets[k]
+                                     + row / GGIT_LOD_BUCKET_ROWS - level->first_bucket[k];
+        cell->commits += 1;
+
+        int n_parents;
+        int const* parents = ggit_parents_of(view->parents, commit_i, &n_parents);
+        for (int j = 0; j < n_parents; ++j) {
+            int const parent = parents[j];
+            if (columns[parent] == k)
+                continue;
+            cell->edge_min = min(cell->edge_min, columns[parent]);
+            cell->edge_max = max(cell->edge_max, columns[parent]);
+        }
+    }
+
+    // Every next level merges pairs of buckets of the previous one.
+    while (level->bucket_rows < height && lod->n_levels < GGIT_LOD_MAX_LEVELS) {
+        struct ggit_lod_level const* finer = level;
+        level = &lod->levels[lod->n_levels++];
+        ggit_lod_level_init(
+            level,
+            finer->bucket_rows * 2,
+            width,
+            lod->row_min,
+            lod->row_max
+        );
+
+        for (int k = 0; k < width; ++k) {
+            int const n = level->offsets[k + 1] - level->offsets[k];
+            for (int i = 0; i < n; ++i) {
+                int const bucket = level->first_bucket[k] + i;
+                struct ggit_lod_cell* cell = level->cells + level->offsets[k] + i;
+                for (int half = 0; half < 2; ++half) {
+                    struct ggit_lod_cell const* from = ggit_lod_cell(
+                        finer,
+                        k,
+                        bucket * 2 + half
+                    );
+                    if (from)
+                        ggit_lod_cell_merge(cell, from);
+                }
+            }
+        }
+    }
+}
+/** The finest level whose buckets span at least `rows_per_bucket` rows. */
+int
+ggit_lod_pick_level(struct ggit_lod const* lod, int rows_per_bucket)
+{
+    int l = 0;
+    while (l + 1 < lod->n_levels && lod->levels[l].bucket_rows < rows_per_bucket)
+        ++l;
+    return l;
+}
+size_t
+ggit_lod_memory_usage(struct ggit_lod const* lod)
+{
+    size_t const width = (size_t)lod->width;
+    size_t total = 0;
+    if (lod->column_branch) {
+        total += width * sizeof(*lod->column_branch);
+        total += width * sizeof(*lod->row_min);
+        total += width * sizeof(*lod->row_max);
+    }
+    for (int l = 0; l < lod->n_levels; ++l) {
+        struct ggit_lod_level const* level = &lod->levels[l];
+        total += width * sizeof(*level->first_bucket);
+        total += (width + 1) * sizeof(*level->offsets);
+        total += (size_t)level->offsets[width] * sizeof(*level->cells);
+    }
+    return total;
+}
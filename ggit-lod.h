@@ -0,0 +1,75 @@
+#pragma once
+
+#include "ggit-graph.h"
+#include "ggit-view.h"
+
+#include <stdint.h>
+
+/* Rows per bucket on the finest level of the pyramid. */
+#define GGIT_LOD_BUCKET_ROWS 4
+#define GGIT_LOD_MAX_LEVELS  32
+
+struct ggit_lod_cell
+{
+    /* Commits of the column inside the bucket. */
+    uint32_t commits;
+
+    /* Range of raw columns reached by edges that leave the column inside the bucket.
+       edge_min > edge_max when there are none. */
+    int16_t edge_min;
+    int16_t edge_max;
+};
+
+struct ggit_lod_level
+{
+    int bucket_rows;
+
+    /* NOTE(boz):
+        Columns only store the buckets between their first and last commit.
+        The cells of column k are [offsets[k], offsets[k + 1]), the first one
+        being bucket first_bucket[k].
+    */
+    int* first_bucket;
+    int* offsets;
+    struct ggit_lod_cell* cells;
+};
+
+/** Mip pyramid of commit counts per (raw column, row bucket).
+ *
+ * Level L buckets span GGIT_LOD_BUCKET_ROWS << L rows, so drawing a zoomed-out view
+ * touches a number of cells that only depends on the screen height.
+ */
+struct ggit_lod
+{
+    /* Serial of the view it was built from. */
+    int revision;
+    int width;
+    int height;
+    int n_levels;
+
+    /* Per raw column: the special branch drawn in it, or -1. */
+    short* column_branch;
+    /* Per raw column: the first and last row holding one of its commits. */
+    int* row_min;
+    int* row_max;
+
+    struct ggit_lod_level levels[GGIT_LOD_MAX_LEVELS];
+};
+
+// clang-format off
+void   ggit_lod_init        (struct ggit_lod* lod);
+void   ggit_lod_destroy     (struct ggit_lod* lod);
+void   ggit_lod_build       (struct ggit_lod* lod, struct ggit_graph const* graph, struct ggit_view const* view, int const* columns);
+int    ggit_lod_pick_level  (struct ggit_lod const* lod, int rows_per_bucket);
+size_t ggit_lod_memory_usage(struct ggit_lod const* lod);
+// clang-format on
+
+/* The cell of `column` covering `bucket`, or NULL if the column has no commits there. */
+static inline struct ggit_lod_cell const*
+ggit_lod_cell(struct ggit_lod_level const* level, int column, int bucket)
+{
+    int const index = bucket - level->first_bucket[column];
+    if (index < 0 || level->offsets[column] + index >= level->offsets[column + 1])
+        return 0;
+    return level->cells + level->offsets[column] + index;
+}
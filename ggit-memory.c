@@ -0,0 +1,71 @@
+#include "ggit-memory.h"
+
+#include <stdio.h>
+
+static char const* const ggit_memory_tag_names[ggit_memory_tag_count] = {
+    [ggit_memory_log] = "log",
+    [ggit_memory_messages] = "messages",
+    [ggit_memory_hashes] = "hashes",
+    [ggit_memory_parents] = "parents",
+    [ggit_memory_tags] = "tags",
+    [ggit_memory_spans] = "spans",
+    [ggit_memory_refs] = "refs",
+    [ggit_memory_metadata] = "metadata",
+    [ggit_memory_render] = "render",
+    [ggit_memory_text] = "text",
+    [ggit_memory_other] = "other",
+};
+
+static double
+ggit_memory_mib(size_t bytes)
+{
+    return (double)bytes / (1024.0 * 1024.0);
+}
+
+char const*
+ggit_memory_tag_name(enum ggit_memory_tag tag)
+{
+    return ggit_memory_tag_names[tag];
+}
+/** Everything but the log, which is gone by the time anyone asks. */
+size_t
+ggit_memory_resident(struct ggit_memory_report const* report)
+{
+    size_t total = 0;
+    for (int t = 0; t < ggit_memory_tag_count; ++t)
+        total += t == ggit_memory_log ? 0 : report->bytes[t];
+    return total;
+}
+/** One "tag  MiB" line per tag and the resident total, snprintf style. */
+int
+ggit_memory_format(struct ggit_memory_report const* report, char* text, size_t size)
+{
+    int length = 0;
+    for (int t = 0; t < ggit_memory_tag_count && (size_t)length < size; ++t) {
+        length += snprintf(
+            text + length,
+            size - length,
+            "%-16s %8.2f MiB%s\n",
+            ggit_memory_tag_names[t],
+            ggit_memory_mib(report->bytes[t]),
+            t == ggit_memory_log ? " (load)" : ""
+        );
+    }
+    if ((size_t)length < size) {
+        length += snprintf(
+            text + length,
+            size - length,
+            "%-16s %8.2f MiB",
+            "resident",
+            ggit_memory_mib(ggit_memory_resident(report))
+        );
+    }
+    return length;
+}
+void
+ggit_memory_print(struct ggit_memory_report const* report, FILE* file)
+{
+    char text[1024];
+    ggit_memory_format(report, text, sizeof(text));
+    fprintf(file, "Memory:\n%s\n", text);
+}
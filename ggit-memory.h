@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdio.h>
+
+/* What the memory is for - every report splits the bytes the same way. */
+enum ggit_memory_tag
+{
+    /* git's output, held while loading and freed once parsed - not resident. */
+    ggit_memory_log,
+    ggit_memory_messages,
+    ggit_memory_hashes,
+    /* The parents, and what's derived from them alone (children, generations, reach...). */
+    ggit_memory_parents,
+    /* Labels, branch instances and what they're classified with. */
+    ggit_memory_tags,
+    ggit_memory_spans,
+    ggit_memory_refs,
+    /* Authors and times, and the filter index over them. */
+    ggit_memory_metadata,
+    /* View, rows, columns, LOD pyramid and the vertex batch. */
+    ggit_memory_render,
+    /* Text textures, at 4 bytes a pixel - SDL doesn't say what they really take. */
+    ggit_memory_text,
+    /* Selection, search and ancestry sets. */
+    ggit_memory_other,
+
+    ggit_memory_tag_count,
+};
+
+/** Bytes per tag, filled in by whoever owns the memory (ggit_graph_memory_report...).
+ *
+ * The counts are capacities - what is allocated, not what is used - walked from the
+ * structures on demand, nothing is counted on the allocation paths.
+ */
+struct ggit_memory_report
+{
+    size_t bytes[ggit_memory_tag_count];
+};
+
+// clang-format off
+char const* ggit_memory_tag_name(enum ggit_memory_tag tag);
+size_t      ggit_memory_resident(struct ggit_memory_report const* report);
+int         ggit_memory_format  (struct ggit_memory_report const* report, char* text, size_t size);
+void        ggit_memory_print   (struct ggit_memory_report const* report, FILE* file);
+// clang-format on
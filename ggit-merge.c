@@ -0,0 +1,457 @@
+#include "ggit-merge.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+/* Trie nodes with patterns on one walk down, deeper ones push out the shallowest. */
+#define GGIT_MERGE_MAX_CANDIDATES 16
+
+enum ggit_merge_segment_kind
+{
+    ggit_merge_segment_text,
+    ggit_merge_segment_main,
+    ggit_merge_segment_kink,
+    ggit_merge_segment_kinks,
+    ggit_merge_segment_any,
+};
+
+/* Piece of a pattern - text to match, or a placeholder. Offsets are into the pattern. */
+struct ggit_merge_segment
+{
+    int kind;
+    int offset;
+    int length;
+};
+
+struct ggit_merge_pattern
+{
+    char* text;
+    /* Used when the message doesn't name the main branch, may be 0. */
+    char* default_main;
+    int first_segment;
+    int n_segments;
+    /* Next pattern with the same leading text, -1 at the end. */
+    int next;
+};
+
+/* Node 0 is the root. Children are a sibling list, there's rarely more than a few. */
+struct ggit_merge_node
+{
+    int first_child;
+    int next_sibling;
+    int first_pattern;
+    char byte;
+};
+
+GGIT_GENERATE_VECTOR_REF_GETTER(struct ggit_merge_node, merge_node)
+GGIT_GENERATE_VECTOR_REF_GETTER(struct ggit_merge_pattern, merge_pattern)
+
+static char*
+ggit_merge_strdup(char const* text)
+{
+    size_t const length = strlen(text);
+    char* copy = (char*)malloc(length + 1);
+    if (!copy) {
+        perror("[ggit_merge_strdup] OOM.");
+        abort();
+    }
+    memcpy(copy, text, length + 1);
+    return copy;
+}
+
+static int
+ggit_merge_node_child(struct ggit_merge_node const* nodes, int node, char byte)
+{
+    for (int c = nodes[node].first_child; c != -1; c = nodes[c].next_sibling) {
+        if (nodes[c].byte == byte)
+            return c;
+    }
+    return -1;
+}
+static int
+ggit_merge_node_insert(struct ggit_merge_patterns* patterns, int length, char const* text)
+{
+    int node = 0;
+    for (int i = 0; i < length; ++i) {
+        int child = ggit_merge_node_child(
+            (struct ggit_merge_node const*)patterns->nodes.data,
+            node,
+            text[i]
+        );
+        if (child == -1) {
+            child = patterns->nodes.size;
+            struct ggit_merge_node const fresh = {
+                .first_child = -1,
+                .next_sibling = ggit_vector_ref_merge_node(&patterns->nodes, node)
+                                    ->first_child,
+                .first_pattern = -1,
+                .byte = text[i],
+            };
+            ggit_vector_push(&patterns->nodes, &fresh);
+            ggit_vector_ref_merge_node(&patterns->nodes, node)->first_child = child;
+        }
+        node = child;
+    }
+    return node;
+}
+
+/* Splits the pattern into segments, false if a placeholder is unknown or two touch. */
+static bool
+ggit_merge_compile(struct ggit_merge_patterns* patterns, char const* text)
+{
+    static struct
+    {
+        char const* name;
+        int kind;
+    } const placeholders[] = {
+        { "{main}", ggit_merge_segment_main },
+        { "{kink}", ggit_merge_segment_kink },
+        { "{kinks}", ggit_merge_segment_kinks },
+        { "{*}", ggit_merge_segment_any },
+    };
+
+    int const length = (int)strlen(text);
+    int text_start = 0;
+    bool last_was_placeholder = false;
+    for (int i = 0; i <= length; ++i) {
+        if (i < length && text[i] != '{')
+            continue;
+
+        if (i > text_start) {
+            struct ggit_merge_segment const segment = {
+                ggit_merge_segment_text,
+                text_start,
+                i - text_start,
+            };
+            ggit_vector_push(&patterns->segments, &segment);
+            last_was_placeholder = false;
+        }
+        if (i == length)
+            break;
+
+        int kind = -1;
+        int name_length = 0;
+        for (int p = 0; p < (int)(sizeof(placeholders) / sizeof(*placeholders)); ++p) {
+            int const n = (int)strlen(placeholders[p].name);
+            if (0 == strncmp(text + i, placeholders[p].name, n)) {
+                kind = placeholders[p].kind;
+                name_length = n;
+                break;
+            }
+        }
+        if (kind == -1 || last_was_placeholder)
+            return false;
+
+        struct ggit_merge_segment const segment = { kind, i, name_length };
+        ggit_vector_push(&patterns->segments, &segment);
+        last_was_placeholder = true;
+        i += name_length - 1;
+        text_start = i + 1;
+    }
+    return true;
+}
+
+void
+ggit_merge_patterns_init(struct ggit_merge_patterns* patterns)
+{
+    ggit_vector_init(&patterns->patterns, sizeof(struct ggit_merge_pattern));
+    ggit_vector_init(&patterns->segments, sizeof(struct ggit_merge_segment));
+    ggit_vector_init(&patterns->nodes, sizeof(struct ggit_merge_node));
+
+    struct ggit_merge_node const root = { -1, -1, -1, 0 };
+    ggit_vector_push(&patterns->nodes, &root);
+}
+void
+ggit_merge_patterns_destroy(struct ggit_merge_patterns* patterns)
+{
+    for (int i = 0; i < patterns->patterns.size; ++i) {
+        struct ggit_merge_pattern* pattern = ggit_vector_ref_merge_pattern(
+            &patterns->patterns,
+            i
+        );
+        free(pattern->text);
+        free(pattern->default_main);
+    }
+    ggit_vector_destroy(&patterns->patterns);
+    ggit_vector_destroy(&patterns->segments);
+    ggit_vector_destroy(&patterns->nodes);
+}
+/** Adds a pattern, see struct ggit_merge_patterns for the syntax.
+ *
+ * False (and nothing added) if the pattern doesn't parse.
+ */
+bool
+ggit_merge_patterns_add(
+    struct ggit_merge_patterns* patterns,
+    char const* pattern,
+    char const* default_main
+)
+{
+    int const first_segment = patterns->segments.size;
+    if (!ggit_merge_compile(patterns, pattern)) {
+        patterns->segments.size = first_segment;
+        fprintf(stderr, "Ignoring merge pattern \"%s\" - can't parse it.\n", pattern);
+        return false;
+    }
+
+    struct ggit_merge_pattern entry = {
+        .text = ggit_merge_strdup(pattern),
+        .default_main = default_main ? ggit_merge_strdup(default_main) : 0,
+        .first_segment = first_segment,
+        .n_segments = patterns->segments.size - first_segment,
+        .next = -1,
+    };
+
+    struct ggit_merge_segment const* first = (struct ggit_merge_segment const*)
+                                                 patterns->segments.data
+                                             + first_segment;
+    int const prefix_length = entry.n_segments > 0
+                                      && first->kind == ggit_merge_segment_text
+                                  ? first->length
+                                  : 0;
+    int const node = ggit_merge_node_insert(patterns, prefix_length, pattern);
+
+    /* NOTE(boz): Appended, so patterns sharing the leading text keep their order. */
+    int const index = patterns->patterns.size;
+    ggit_vector_push(&patterns->patterns, &entry);
+    int* link = &ggit_vector_ref_merge_node(&patterns->nodes, node)->first_pattern;
+    while (*link != -1)
+        link = &ggit_vector_ref_merge_pattern(&patterns->patterns, *link)->next;
+    *link = index;
+    return true;
+}
+/** The formats git, GitHub, GitLab and Bitbucket write. */
+void
+ggit_merge_patterns_add_defaults(struct ggit_merge_patterns* patterns)
+{
+    // clang-format off
+    /* GitHub */
+    ggit_merge_patterns_add(patterns, "Merge pull request #{*} from {*}/{kink}",         0);
+    /* GitLab */
+    ggit_merge_patterns_add(patterns, "Merge branch '{kink}' into '{main}'",             0);
+    /* git */
+    ggit_merge_patterns_add(patterns, "Merge branch '{kink}' of {*} into {main}",        0);
+    ggit_merge_patterns_add(patterns, "Merge branch '{kink}' into {main}",               0);
+    ggit_merge_patterns_add(patterns, "Merge branch '{kink}'",                           "master");
+    ggit_merge_patterns_add(patterns, "Merge branches {kinks} of {*} into {main}",       0);
+    ggit_merge_patterns_add(patterns, "Merge branches {kinks} into {main}",              0);
+    ggit_merge_patterns_add(patterns, "Merge branches {kinks}",                          "master");
+    ggit_merge_patterns_add(patterns, "Merge remote-tracking branch '{*}/{kink}' into {main}", 0);
+    ggit_merge_patterns_add(patterns, "Merge remote-tracking branch '{*}/{kink}'",       "master");
+    /* Bitbucket */
+    ggit_merge_patterns_add(patterns, "Merged in {kink}",                                0);
+    ggit_merge_patterns_add(patterns, "Merged {kink} into {main}",                       0);
+    // clang-format on
+}
+
+static int
+ggit_merge_find(char const* p, char const* end, char const* text, int length)
+{
+    char const* const start = p;
+    char const* const last = end - length;
+    for (; p <= last; ++p) {
+        p = (char const*)memchr(p, text[0], last - p + 1);
+        if (!p)
+            break;
+        if (0 == memcmp(p, text, length))
+            return (int)(p - start);
+    }
+    return -1;
+}
+static bool
+ggit_merge_has_space(char const* text, int length)
+{
+    for (int i = 0; i < length; ++i) {
+        if (isspace((unsigned char)text[i]))
+            return true;
+    }
+    return false;
+}
+static void
+ggit_merge_add_kink(struct ggit_merge_match* match, char const* text, int length)
+{
+    if (match->n_kinks < GGIT_MERGE_MAX_KINKS)
+        match->kinks[match->n_kinks++] = (struct ggit_merge_name){ text, length };
+}
+/* 'a', 'b' and 'c' - the way git lists the branches of an octopus. */
+static char const*
+ggit_merge_match_list(char const* p, char const* end, struct ggit_merge_match* match)
+{
+    static char const* const separators[] = { ", and ", ", ", " and " };
+    while (true) {
+        if (p == end || *p != '\'')
+            return 0;
+        char const* close = (char const*)memchr(p + 1, '\'', end - p - 1);
+        if (!close || close == p + 1)
+            return 0;
+        ggit_merge_add_kink(match, p + 1, (int)(close - p - 1));
+        p = close + 1;
+
+        int s = 0;
+        for (; s < (int)(sizeof(separators) / sizeof(*separators)); ++s) {
+            int const n = (int)strlen(separators[s]);
+            if (end - p >= n && 0 == memcmp(p, separators[s], n))
+                break;
+        }
+        if (s == (int)(sizeof(separators) / sizeof(*separators)))
+            return p;
+        p += strlen(separators[s]);
+    }
+}
+/* Everything after the leading text, which the trie already matched. */
+static bool
+ggit_merge_match_pattern(
+    struct ggit_merge_patterns const* patterns,
+    struct ggit_merge_pattern const* pattern,
+    char const* p,
+    char const* end,
+    struct ggit_merge_match* match
+)
+{
+    struct ggit_merge_segment const* segments = (struct ggit_merge_segment const*)
+                                                    patterns->segments.data
+                                                + pattern->first_segment;
+    int const n = pattern->n_segments;
+
+    *match = (struct ggit_merge_match){ 0 };
+    int i = n > 0 && segments[0].kind == ggit_merge_segment_text ? 1 : 0;
+    for (; i < n; ++i) {
+        struct ggit_merge_segment const* segment = segments + i;
+        char const* text = pattern->text + segment->offset;
+
+        if (segment->kind == ggit_merge_segment_text) {
+            if (end - p < segment->length || 0 != memcmp(p, text, segment->length))
+                return false;
+            p += segment->length;
+            continue;
+        }
+        if (segment->kind == ggit_merge_segment_kinks) {
+            p = ggit_merge_match_list(p, end, match);
+            if (!p)
+                return false;
+            continue;
+        }
+
+        int length;
+        if (i + 1 < n) {
+            struct ggit_merge_segment const* next = segment + 1;
+            length = ggit_merge_find(
+                p,
+                end,
+                pattern->text + next->offset,
+                next->length
+            );
+            if (length == -1)
+                return false;
+        } else if (segment->kind == ggit_merge_segment_any) {
+            length = (int)(end - p);
+        } else {
+            length = 0;
+            while (p + length < end && !isspace((unsigned char)p[length]))
+                ++length;
+        }
+        if (length == 0)
+            return false;
+
+        switch (segment->kind) {
+            case ggit_merge_segment_main:
+                if (ggit_merge_has_space(p, length))
+                    return false;
+                match->main = (struct ggit_merge_name){ p, length };
+                break;
+            case ggit_merge_segment_kink:
+                if (ggit_merge_has_space(p, length))
+                    return false;
+                ggit_merge_add_kink(match, p, length);
+                break;
+        }
+        p += length;
+    }
+
+    if (!match->main.text && pattern->default_main) {
+        match->main = (struct ggit_merge_name){
+            pattern->default_main,
+            (int)strlen(pattern->default_main),
+        };
+    }
+    return true;
+}
+/** Recognizes a merge message, names in `out_match` point into the message.
+ *
+ * One walk down the trie, then the patterns of the deepest matching prefixes.
+ * Nothing is allocated. False if no pattern matches.
+ */
+bool
+ggit_merge_match(
+    struct ggit_merge_patterns const* patterns,
+    int length,
+    char const* message,
+    struct ggit_merge_match* out_match
+)
+{
+    struct ggit_merge_node const* nodes = (struct ggit_merge_node const*)
+                                              patterns->nodes.data;
+    struct ggit_merge_pattern const* entries = (struct ggit_merge_pattern const*)
+                                                   patterns->patterns.data;
+
+    int candidates[GGIT_MERGE_MAX_CANDIDATES];
+    int depths[GGIT_MERGE_MAX_CANDIDATES];
+    int n_candidates = 0;
+
+    int node = 0;
+    for (int depth = 0;; ++depth) {
+        if (nodes[node].first_pattern != -1) {
+            if (n_candidates == GGIT_MERGE_MAX_CANDIDATES) {
+                memmove(candidates, candidates + 1, (n_candidates - 1) * sizeof(int));
+                memmove(depths, depths + 1, (n_candidates - 1) * sizeof(int));
+                --n_candidates;
+            }
+            candidates[n_candidates] = node;
+            depths[n_candidates] = depth;
+            ++n_candidates;
+        }
+        if (depth == length)
+            break;
+        node = ggit_merge_node_child(nodes, node, message[depth]);
+        if (node == -1)
+            break;
+    }
+
+    struct ggit_merge_match match;
+    for (int c = n_candidates - 1; c >= 0; --c) {
+        int const p = nodes[candidates[c]].first_pattern;
+        for (int e = p; e != -1; e = entries[e].next) {
+            if (ggit_merge_match_pattern(
+                    patterns,
+                    entries + e,
+                    message + depths[c],
+                    message + length,
+                    &match
+                )) {
+                *out_match = match;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+size_t
+ggit_merge_patterns_memory_usage(struct ggit_merge_patterns const* patterns)
+{
+    size_t total = 0;
+    total += (size_t)patterns->patterns.capacity * patterns->patterns.value_size;
+    total += (size_t)patterns->segments.capacity * patterns->segments.value_size;
+    total += (size_t)patterns->nodes.capacity * patterns->nodes.value_size;
+    for (int i = 0; i < patterns->patterns.size; ++i) {
+        struct ggit_merge_pattern const* pattern = (struct ggit_merge_pattern const*)
+                                                       patterns->patterns.data
+                                                   + i;
+        total += strlen(pattern->text) + 1;
+        if (pattern->default_main)
+            total += strlen(pattern->default_main) + 1;
+    }
+    return total;
+}
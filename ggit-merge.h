@@ -0,0 +1,56 @@
+#pragma once
+
+#include "ggit-vector.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Branch names kept from one octopus merge message, the rest are dropped. */
+#define GGIT_MERGE_MAX_KINKS 16
+
+/** Merge message recognizer.
+ *
+ * Patterns are plain text with placeholders:
+ *     {main}  - the branch merged into
+ *     {kink}  - the branch that got merged
+ *     {kinks} - a list of quoted names, 'a', 'b' and 'c'
+ *     {*}     - anything, thrown away
+ *
+ * The text before the first placeholder goes into a prefix trie, so a message is
+ * walked once from the start and only the patterns whose leading text matched get
+ * to look at the rest. Deeper (longer) prefixes are tried first, patterns sharing
+ * a prefix are tried in the order they were added.
+ *
+ * A placeholder followed by text ends where that text first shows up. One at the
+ * end of the pattern ends at the first whitespace, except {*} which takes the rest.
+ * Branch names never contain whitespace. Anything after the pattern is ignored.
+ */
+struct ggit_merge_patterns
+{
+    /* [struct ggit_merge_pattern] */ struct ggit_vector patterns;
+    /* [struct ggit_merge_segment] */ struct ggit_vector segments;
+    /* [struct ggit_merge_node]    */ struct ggit_vector nodes;
+};
+
+/* Slice of the message, not NUL terminated. text is 0 if there's no name. */
+struct ggit_merge_name
+{
+    char const* text;
+    int length;
+};
+
+struct ggit_merge_match
+{
+    struct ggit_merge_name main;
+    int n_kinks;
+    struct ggit_merge_name kinks[GGIT_MERGE_MAX_KINKS];
+};
+
+// clang-format off
+void   ggit_merge_patterns_init        (struct ggit_merge_patterns* patterns);
+void   ggit_merge_patterns_destroy     (struct ggit_merge_patterns* patterns);
+bool   ggit_merge_patterns_add         (struct ggit_merge_patterns* patterns, char const* pattern, char const* default_main);
+void   ggit_merge_patterns_add_defaults(struct ggit_merge_patterns* patterns);
+bool   ggit_merge_match                (struct ggit_merge_patterns const* patterns, int length, char const* message, struct ggit_merge_match* out_match);
+size_t ggit_merge_patterns_memory_usage(struct ggit_merge_patterns const* patterns);
+// clang-format on
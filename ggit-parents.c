@@ -0,0 +1,76 @@
+#include "ggit-parents.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+void
+ggit_parents_init(struct ggit_parents* parents)
+{
+    memset(parents, 0, sizeof(*parents));
+    ggit_vec_u32_init(&parents->block_base);
+    ggit_vec_u16_init(&parents->local);
+    ggit_vec_int_init(&parents->parents);
+    ggit_parents_clear(parents);
+}
+void
+ggit_parents_destroy(struct ggit_parents* parents)
+{
+    ggit_vec_u32_destroy(&parents->block_base);
+    ggit_vec_u16_destroy(&parents->local);
+    ggit_vec_int_destroy(&parents->parents);
+    parents->count = 0;
+}
+/** Back to no commits. Keeps the memory. */
+void
+ggit_parents_clear(struct ggit_parents* parents)
+{
+    ggit_vec_u32_clear(&parents->block_base);
+    ggit_vec_u16_clear(&parents->local);
+    ggit_vec_int_clear(&parents->parents);
+    ggit_vec_u32_push(&parents->block_base, 0);
+    ggit_vec_u16_push(&parents->local, 0);
+    parents->count = 0;
+}
+void
+ggit_parents_reserve(struct ggit_parents* parents, int commits, int edges)
+{
+    ggit_vec_u32_reserve(&parents->block_base, (size_t)(commits >> 6) + 1);
+    ggit_vec_u16_reserve(&parents->local, (size_t)commits + 1);
+    ggit_vec_int_reserve(&parents->parents, (size_t)edges);
+}
+/** Appends the next commit with its `n` parents. */
+void
+ggit_parents_push(struct ggit_parents* parents, int const* commit_parents, int n)
+{
+    for (int i = 0; i < n; ++i)
+        ggit_vec_int_push(&parents->parents, commit_parents[i]);
+    ggit_parents_end_commit(parents);
+}
+/** Appends the next commit, its parents are the ones pushed to `parents` since the last one. */
+void
+ggit_parents_end_commit(struct ggit_parents* parents)
+{
+    int const next = ++parents->count;
+    uint32_t const end = (uint32_t)parents->parents.size;
+    if ((next & 63) == 0)
+        ggit_vec_u32_push(&parents->block_base, end);
+
+    uint32_t const base = parents->block_base.data[next >> 6];
+    if (end - base > UINT16_MAX) {
+        /* NOTE(boz): 64 commits with more than 65535 parents between them. */
+        fprintf(stderr, "[ggit_parents_push] Too many parents in one block.\n");
+        abort();
+    }
+    uint16_t const local = (uint16_t)(end - base);
+    ggit_vec_u16_push(&parents->local, local);
+}
+/** Bytes allocated - the capacity of the vectors, not just what's in use. */
+size_t
+ggit_parents_memory_usage(struct ggit_parents const* parents)
+{
+    return ggit_vec_u32_memory_usage(&parents->block_base)
+           + ggit_vec_u16_memory_usage(&parents->local)
+           + ggit_vec_int_memory_usage(&parents->parents);
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "ggit-vector.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** Parents of every commit, any number of them - octopus merges included.
+ *
+ * The parents of c are parents[offset(c) .. offset(c + 1)], first parent first.
+ * An offset is a 32-bit base per block of 64 commits plus a 16-bit offset inside
+ * the block, so a commit costs ~2 bytes plus 4 per parent instead of a fixed 8.
+ */
+struct ggit_parents
+{
+    int count;
+
+    /* Offset of the first parent of every 64th commit. */
+    struct ggit_vec_u32 block_base;
+    /* count + 1 entries, relative to the block base of the same index. */
+    struct ggit_vec_u16 local;
+    struct ggit_vec_int parents;
+};
+
+// clang-format off
+void   ggit_parents_init        (struct ggit_parents* parents);
+void   ggit_parents_destroy     (struct ggit_parents* parents);
+void   ggit_parents_clear       (struct ggit_parents* parents);
+void   ggit_parents_reserve     (struct ggit_parents* parents, int commits, int edges);
+void   ggit_parents_push        (struct ggit_parents* parents, int const* commit_parents, int n);
+void   ggit_parents_end_commit  (struct ggit_parents* parents);
+size_t ggit_parents_memory_usage(struct ggit_parents const* parents);
+// clang-format on
+
+static inline int
+ggit_parents_offset(struct ggit_parents const* parents, int commit)
+{
+    return (int)parents->block_base.data[commit >> 6] + parents->local.data[commit];
+}
+/* Parents of the commit, first parent first. */
+static inline int const*
+ggit_parents_of(struct ggit_parents const* parents, int commit, int* out_count)
+{
+    int const begin = ggit_parents_offset(parents, commit);
+    *out_count = ggit_parents_offset(parents, commit + 1) - begin;
+    return parents->parents.data + begin;
+}
+static inline int
+ggit_parents_count(struct ggit_parents const* parents, int commit)
+{
+    return ggit_parents_offset(parents, commit + 1) - ggit_parents_offset(parents, commit);
+}
+/* First parent, -1 for a root commit. */
+static inline int
+ggit_parents_first(struct ggit_parents const* parents, int commit)
+{
+    int n;
+    int const* p = ggit_parents_of(parents, commit, &n);
+    return n ? p[0] : -1;
+}
@@ -0,0 +1,134 @@
+#include "ggit-profile.h"
+
+#include <SDL2/SDL_timer.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct ggit_profile ggit_profiler;
+
+static char const* const ggit_profile_pass_names[ggit_profile_pass_count] = {
+    [ggit_profile_pass_refs] = "refs",
+    [ggit_profile_pass_spans] = "spans",
+    [ggit_profile_pass_connections] = "connections",
+    [ggit_profile_pass_commit_messages] = "commit_messages",
+    [ggit_profile_pass_boxes] = "boxes",
+    [ggit_profile_pass_lod] = "lod",
+    [ggit_profile_pass_overlay] = "overlay",
+    [ggit_profile_pass_present] = "present",
+    [ggit_profile_pass_hud] = "hud",
+};
+
+static float
+ggit_profile_ms(uint64_t ticks)
+{
+    return (float)((double)ticks * 1000.0 / (double)ggit_profiler.frequency);
+}
+
+static int
+compare_float(void const* a, void const* b)
+{
+    float fa = *(float const*)a;
+    float fb = *(float const*)b;
+    return (fa > fb) - (fa < fb);
+}
+
+void
+ggit_profile_init(void)
+{
+    memset(&ggit_profiler, 0, sizeof(ggit_profiler));
+    ggit_profiler.frequency = SDL_GetPerformanceFrequency();
+}
+void
+ggit_profile_frame_begin(void)
+{
+    memset(&ggit_profiler.current, 0, sizeof(ggit_profiler.current));
+    ggit_profiler.frame_start = SDL_GetPerformanceCounter();
+}
+void
+ggit_profile_frame_end(void)
+{
+    uint64_t now = SDL_GetPerformanceCounter();
+    ggit_profiler.current.frame_ms = ggit_profile_ms(now - ggit_profiler.frame_start);
+
+    int slot = ggit_profiler.frames % GGIT_PROFILE_HISTORY;
+    ggit_profiler.history[slot] = ggit_profiler.current;
+    ggit_profiler.frames += 1;
+}
+void
+ggit_profile_pass_begin(enum ggit_profile_pass pass)
+{
+    ggit_profiler.pass_start[pass] = SDL_GetPerformanceCounter();
+}
+void
+ggit_profile_pass_end(enum ggit_profile_pass pass)
+{
+    uint64_t now = SDL_GetPerformanceCounter();
+    ggit_profiler.current.pass_ms[pass] += ggit_profile_ms(
+        now - ggit_profiler.pass_start[pass]
+    );
+}
+/** Memory of the frame being timed, for the HUD and the CSV. Call before ggit_profile_frame_end. */
+void
+ggit_profile_set_memory(struct ggit_memory_report const* report)
+{
+    ggit_profiler.current.memory = *report;
+}
+char const*
+ggit_profile_pass_name(enum ggit_profile_pass pass)
+{
+    return ggit_profile_pass_names[pass];
+}
+/** Percentile (0..1) of the frame times kept in the history. */
+float
+ggit_profile_percentile(float percentile)
+{
+    float sorted[GGIT_PROFILE_HISTORY];
+    int n = min(ggit_profiler.frames, GGIT_PROFILE_HISTORY);
+    if (n == 0)
+        return 0.0f;
+
+    for (int i = 0; i < n; ++i)
+        sorted[i] = ggit_profiler.history[i].frame_ms;
+    qsort(sorted, n, sizeof(float), compare_float);
+
+    int index = (int)(percentile * (float)(n - 1) + 0.5f);
+    return sorted[max(0, min(n - 1, index))];
+}
+bool
+ggit_profile_dump_csv(char const* path)
+{
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        perror("[ggit_profile_dump_csv] fopen");
+        return false;
+    }
+
+    fprintf(file, "frame,frame_ms");
+    for (int p = 0; p < ggit_profile_pass_count; ++p)
+        fprintf(file, ",%s_ms", ggit_profile_pass_names[p]);
+    fprintf(file, ",draw_calls,vertices");
+    for (int t = 0; t < ggit_memory_tag_count; ++t)
+        fprintf(file, ",%s_bytes", ggit_memory_tag_name(t));
+    fprintf(file, "\n");
+
+    int n = min(ggit_profiler.frames, GGIT_PROFILE_HISTORY);
+    int first = ggit_profiler.frames - n;
+    for (int i = 0; i < n; ++i) {
+        int frame = first + i;
+        int slot = frame % GGIT_PROFILE_HISTORY;
+        struct ggit_profile_frame const* f = &ggit_profiler.history[slot];
+        fprintf(file, "%d,%.4f", frame, f->frame_ms);
+        for (int p = 0; p < ggit_profile_pass_count; ++p)
+            fprintf(file, ",%.4f", f->pass_ms[p]);
+        fprintf(file, ",%d,%d", f->draw_calls, f->vertices);
+        for (int t = 0; t < ggit_memory_tag_count; ++t)
+            fprintf(file, ",%zu", f->memory.bytes[t]);
+        fprintf(file, "\n");
+    }
+
+    fclose(file);
+    printf("Profile: wrote %d frames to %s\n", n, path);
+    return true;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "ggit-memory.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Frames kept for the rolling graph and the CSV dump. */
+#define GGIT_PROFILE_HISTORY 240
+
+enum ggit_profile_pass
+{
+    ggit_profile_pass_refs,
+    ggit_profile_pass_spans,
+    ggit_profile_pass_connections,
+    ggit_profile_pass_commit_messages,
+    ggit_profile_pass_boxes,
+    ggit_profile_pass_lod,
+    ggit_profile_pass_overlay,
+    ggit_profile_pass_present,
+    ggit_profile_pass_hud,
+
+    ggit_profile_pass_count,
+};
+
+struct ggit_profile_frame
+{
+    float frame_ms;
+    float pass_ms[ggit_profile_pass_count];
+    int draw_calls;
+    int vertices;
+    /* What was allocated at the end of the frame, see ggit_profile_set_memory. */
+    struct ggit_memory_report memory;
+};
+
+struct ggit_profile
+{
+    bool visible;
+
+    uint64_t frequency;
+    uint64_t frame_start;
+    uint64_t pass_start[ggit_profile_pass_count];
+
+    /* Frames finished so far. history[] is a ring buffer indexed by frames % size. */
+    int frames;
+    struct ggit_profile_frame current;
+    struct ggit_profile_frame history[GGIT_PROFILE_HISTORY];
+};
+
+extern struct ggit_profile ggit_profiler;
+
+// clang-format off
+void        ggit_profile_init       (void);
+void        ggit_profile_frame_begin(void);
+void        ggit_profile_frame_end  (void);
+void        ggit_profile_pass_begin (enum ggit_profile_pass pass);
+void        ggit_profile_pass_end   (enum ggit_profile_pass pass);
+char const* ggit_profile_pass_name  (enum ggit_profile_pass pass);
+float       ggit_profile_percentile (float percentile);
+bool        ggit_profile_dump_csv   (char const* path);
+void        ggit_profile_set_memory (struct ggit_memory_report const* report);
+// clang-format on
+
+static inline void
+ggit_profile_count_draw(int vertices)
+{
+    ggit_profiler.current.draw_calls += 1;
+    ggit_profiler.current.vertices += vertices;
+}
@@ -0,0 +1,260 @@
+#include "ggit-search.h"
+
+#include <SDL2/SDL_cpuinfo.h>
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define GGIT_SEARCH_SSE2
+#endif
+
+/* Bytes scanned between two looks at the generation counter. */
+#define GGIT_SEARCH_CANCEL_BYTES (64 * 1024)
+
+/** First byte in [p, end) equal to `a` or `b`, or end. */
+static char const*
+ggit_search_find_byte(char const* p, char const* end, char a, char b)
+{
+#ifdef GGIT_SEARCH_SSE2
+    __m128i const va = _mm_set1_epi8(a);
+    __m128i const vb = _mm_set1_epi8(b);
+    while (end - p >= 16) {
+        __m128i const block = _mm_loadu_si128((__m128i const*)p);
+        __m128i const hits = _mm_or_si128(_mm_cmpeq_epi8(block, va), _mm_cmpeq_epi8(block, vb));
+        int const mask = _mm_movemask_epi8(hits);
+        if (mask)
+            return p + ggit_ctz64((uint64_t)mask);
+        p += 16;
+    }
+#endif
+    for (; p < end; ++p) {
+        if (*p == a || *p == b)
+            return p;
+    }
+    return end;
+}
+static bool
+ggit_search_equals_nocase(char const* text, char const* lower_pattern, int length)
+{
+    for (int i = 0; i < length; ++i) {
+        if (tolower((unsigned char)text[i]) != lower_pattern[i])
+            return false;
+    }
+    return true;
+}
+static bool
+ggit_search_cancelled(struct ggit_search* search, int generation)
+{
+    return SDL_AtomicGet(&search->generation) != generation;
+}
+/** Scans the messages of commits [c0, c1) into `words`. False if cancelled half way. */
+static bool
+ggit_search_scan(struct ggit_search* search, int generation, int c0, int c1, uint64_t* words)
+{
+    struct ggit_graph const* graph = search->graph;
+    char* const* messages = graph->messages;
+
+    if (search->mode == ggit_search_regex) {
+        for (int c = c0; c < c1; ++c) {
+            if ((c & 255) == 0 && ggit_search_cancelled(search, generation))
+                return false;
+            if (regex_matchp(search->regex, messages[c]) != -1)
+                words[(c - c0) >> 6] |= (uint64_t)1 << ((c - c0) & 63);
+        }
+        return true;
+    }
+
+    /* NOTE(boz):
+        One pass over the chunk's slice of the store. Candidates come from the
+        first byte of the pattern (both cases for nocase), everything else is
+        skipped 16 bytes at a time. A hit finishes the message it is in.
+    */
+    char const* const pattern = search->pattern;
+    int const length = search->pattern_length;
+    bool const nocase = search->mode == ggit_search_nocase;
+    char const first_a = pattern[0];
+    char const first_b = nocase ? (char)toupper((unsigned char)pattern[0]) : pattern[0];
+
+    char const* p = messages[c0];
+    char const* const end = c1 < graph->height ? messages[c1]
+                                               : graph->message_store + graph->message_store_size;
+    char const* const limit = end - length + 1;
+    char const* next_check = p + GGIT_SEARCH_CANCEL_BYTES;
+
+    int c = c0;
+    while (p < limit) {
+        p = ggit_search_find_byte(p, limit, first_a, first_b);
+        if (p >= limit)
+            break;
+        if (p >= next_check) {
+            if (ggit_search_cancelled(search, generation))
+                return false;
+            next_check = p + GGIT_SEARCH_CANCEL_BYTES;
+        }
+
+        bool const hit = nocase ? ggit_search_equals_nocase(p, pattern, length)
+                                : 0 == memcmp(p, pattern, length);
+        if (!hit) {
+            ++p;
+            continue;
+        }
+
+        while (c + 1 < c1 && messages[c + 1] <= p)
+            ++c;
+        words[(c - c0) >> 6] |= (uint64_t)1 << ((c - c0) & 63);
+        p = c + 1 < c1 ? messages[c + 1] : end;
+    }
+    return true;
+}
+static int
+ggit_search_worker(void* data)
+{
+    struct ggit_search* search = (struct ggit_search*)data;
+    uint64_t words[GGIT_SEARCH_CHUNK / 64];
+
+    SDL_LockMutex(search->lock);
+    while (!search->quit) {
+        if (SDL_AtomicGet(&search->next_chunk) >= search->n_chunks) {
+            SDL_CondWait(search->wake, search->lock);
+            continue;
+        }
+        int const generation = SDL_AtomicGet(&search->generation);
+        int const n_chunks = search->n_chunks;
+        int const height = search->graph->height;
+        search->active_workers += 1;
+        SDL_UnlockMutex(search->lock);
+
+        while (true) {
+            int const chunk = SDL_AtomicAdd(&search->next_chunk, 1);
+            if (chunk >= n_chunks)
+                break;
+            int const c0 = chunk * GGIT_SEARCH_CHUNK;
+            int const c1 = min(c0 + GGIT_SEARCH_CHUNK, height);
+
+            memset(words, 0, sizeof(words));
+            if (!ggit_search_scan(search, generation, c0, c1, words))
+                break;
+
+            SDL_LockMutex(search->lock);
+            if (!ggit_search_cancelled(search, generation)) {
+                memcpy(
+                    search->matches.words + (c0 >> 6),
+                    words,
+                    ggit_bitset_words(c1 - c0) * sizeof(uint64_t)
+                );
+                search->chunks_done += 1;
+            }
+            SDL_UnlockMutex(search->lock);
+        }
+
+        SDL_LockMutex(search->lock);
+        search->active_workers -= 1;
+        SDL_CondBroadcast(search->wake);
+    }
+    SDL_UnlockMutex(search->lock);
+    return 0;
+}
+/* Stops the running query. Returns with the lock held and no worker running. */
+static void
+ggit_search_stop_locked(struct ggit_search* search)
+{
+    SDL_LockMutex(search->lock);
+    SDL_AtomicIncRef(&search->generation);
+    search->n_chunks = 0;
+    while (search->active_workers)
+        SDL_CondWait(search->wake, search->lock);
+
+    if (search->regex)
+        regex_free(search->regex);
+    search->regex = 0;
+    search->graph = 0;
+    search->chunks_done = 0;
+    search->chunks_collected = -1;
+    ggit_bitset_clear(&search->matches);
+}
+
+void
+ggit_search_init(struct ggit_search* search)
+{
+    memset(search, 0, sizeof(*search));
+    ggit_bitset_init(&search->matches);
+    search->lock = SDL_CreateMutex();
+    search->wake = SDL_CreateCond();
+
+    search->n_threads = max(1, min(SDL_GetCPUCount() - 1, GGIT_SEARCH_MAX_THREADS));
+    for (int i = 0; i < search->n_threads; ++i)
+        search->threads[i] = SDL_CreateThread(ggit_search_worker, "ggit-search", search);
+}
+void
+ggit_search_destroy(struct ggit_search* search)
+{
+    ggit_search_stop_locked(search);
+    search->quit = true;
+    SDL_CondBroadcast(search->wake);
+    SDL_UnlockMutex(search->lock);
+
+    for (int i = 0; i < search->n_threads; ++i)
+        SDL_WaitThread(search->threads[i], 0);
+    SDL_DestroyCond(search->wake);
+    SDL_DestroyMutex(search->lock);
+    ggit_bitset_destroy(&search->matches);
+}
+/** Replaces the running query. False if the pattern doesn't compile. */
+bool
+ggit_search_start(
+    struct ggit_search* search,
+    struct ggit_graph const* graph,
+    enum ggit_search_mode mode,
+    char const* pattern
+)
+{
+    ggit_search_stop_locked(search);
+    ggit_bitset_resize(&search->matches, graph->height);
+
+    int const length = (int)strlen(pattern);
+    bool ok = length < (int)sizeof(search->pattern);
+    if (ok && mode == ggit_search_regex) {
+        search->regex = regex_compile(pattern);
+        ok = search->regex != 0;
+    }
+    if (ok && length) {
+        for (int i = 0; i <= length; ++i)
+            search->pattern[i] = mode == ggit_search_nocase
+                                     ? (char)tolower((unsigned char)pattern[i])
+                                     : pattern[i];
+        search->pattern_length = length;
+        search->mode = mode;
+        search->graph = graph;
+        search->n_chunks = (graph->height + GGIT_SEARCH_CHUNK - 1) / GGIT_SEARCH_CHUNK;
+        SDL_AtomicSet(&search->next_chunk, 0);
+        SDL_CondBroadcast(search->wake);
+    }
+    SDL_UnlockMutex(search->lock);
+    return ok;
+}
+/** Stops the running query - call before the graph it searches goes away. */
+void
+ggit_search_cancel(struct ggit_search* search)
+{
+    ggit_search_stop_locked(search);
+    SDL_UnlockMutex(search->lock);
+}
+/** Copies the matches found so far. Returns false when nothing new came in since last time. */
+bool
+ggit_search_collect(struct ggit_search* search, struct ggit_bitset* out_matches, bool* out_running)
+{
+    SDL_LockMutex(search->lock);
+    bool const changed = search->chunks_collected != search->chunks_done;
+    if (changed) {
+        ggit_bitset_copy(out_matches, &search->matches);
+        search->chunks_collected = search->chunks_done;
+    }
+    *out_running = search->chunks_done < search->n_chunks;
+    SDL_UnlockMutex(search->lock);
+    return changed;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "ggit-bitset.h"
+#include "ggit-graph.h"
+
+#include <SDL2/SDL_atomic.h>
+#include <SDL2/SDL_mutex.h>
+#include <SDL2/SDL_thread.h>
+
+#include <libsmallregex.h>
+
+#define GGIT_SEARCH_MAX_THREADS 16
+/* Commits per work item. A multiple of 64, so chunks never share a bitset word. */
+#define GGIT_SEARCH_CHUNK 4096
+
+enum ggit_search_mode
+{
+    ggit_search_substring,
+    ggit_search_nocase,
+    ggit_search_regex,
+};
+
+/** Background search over the commit subjects.
+ *
+ * A pool of workers takes chunks of commits and scans their part of the message
+ * store. Starting a new query bumps `generation`, the workers notice it between
+ * a few kilobytes of text and drop what they were doing - typing never waits
+ * for the previous query to finish.
+ */
+struct ggit_search
+{
+    SDL_Thread* threads[GGIT_SEARCH_MAX_THREADS];
+    int n_threads;
+
+    SDL_mutex* lock;
+    SDL_cond* wake;
+    bool quit;
+
+    SDL_atomic_t generation;
+    SDL_atomic_t next_chunk;
+
+    /* NOTE(boz):
+        The query - only changed under the lock, once no worker is running.
+    */
+    struct ggit_graph const* graph;
+    enum ggit_search_mode mode;
+    char pattern[256];
+    int pattern_length;
+    struct small_regex* regex;
+    int n_chunks;
+
+    /* Under the lock. */
+    int active_workers;
+    int chunks_done;
+    int chunks_collected;
+    struct ggit_bitset matches;
+};
+
+// clang-format off
+void ggit_search_init   (struct ggit_search* search);
+void ggit_search_destroy(struct ggit_search* search);
+bool ggit_search_start  (struct ggit_search* search, struct ggit_graph const* graph, enum ggit_search_mode mode, char const* pattern);
+void ggit_search_cancel (struct ggit_search* search);
+bool ggit_search_collect(struct ggit_search* search, struct ggit_bitset* out_matches, bool* out_running);
+// clang-format on
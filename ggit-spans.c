@@ -0,0 +1,286 @@
+#include "ggit-spans.h"
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Do the spans get in each other's way when drawn in one column?
+ *
+ * Spans touching at a commit don't collide - that's the merge commit both of them
+ * point at. Empty and broken spans collide with everything.
+ */
+bool
+ggit_spans_collide(struct ggit_column_span const* a, struct ggit_column_span const* b)
+{
+    int am_min = a->merge_min;
+    int am_max = a->merge_max;
+    int bm_min = b->merge_min;
+    int bm_max = b->merge_max;
+
+    if (bm_min == -1 && bm_max == -1)
+        return false;
+
+    if ((am_min | am_max | bm_min | bm_max) < 0)
+        return true;
+
+    if (am_min > am_max) {
+        return true;
+    }
+    if (bm_min > bm_max) {
+        return true;
+    }
+
+    if (am_max < bm_max)
+        return ggit_spans_collide(b, a);
+
+    /*
+        From this point on
+        A always reaches "higher" than B.
+    */
+
+    return am_min < bm_max;
+}
+void
+ggit_spans_join(struct ggit_column_span* restrict inout, struct ggit_column_span const* restrict in)
+{
+    inout->commit_min = inout->commit_min < in->commit_min ? inout->commit_min : in->commit_min;
+    inout->commit_max = inout->commit_max > in->commit_max ? inout->commit_max : in->commit_max;
+    inout->merge_min = inout->merge_min < in->merge_min ? inout->merge_min : in->merge_min;
+    inout->merge_max = inout->merge_max > in->merge_max ? inout->merge_max : in->merge_max;
+}
+static bool
+ggit_span_is_valid(struct ggit_column_span const* span)
+{
+    return span->merge_min >= 0 && span->merge_min <= span->merge_max;
+}
+
+void
+ggit_span_index_init(struct ggit_span_index* index)
+{
+    memset(index, 0, sizeof(*index));
+    ggit_vector_init(&index->slots, sizeof(int));
+    ggit_vector_init(&index->hulls, sizeof(struct ggit_column_span));
+    ggit_vector_init(&index->entries, sizeof(struct ggit_span_entry));
+}
+void
+ggit_span_index_destroy(struct ggit_span_index* index)
+{
+    free(index->tree_max);
+    free(index->tree_min);
+    ggit_vector_destroy(&index->slots);
+    ggit_vector_destroy(&index->hulls);
+    ggit_vector_destroy(&index->entries);
+    memset(index, 0, sizeof(*index));
+}
+void
+ggit_span_index_clear(struct ggit_span_index* index)
+{
+    index->size = 0;
+    for (int node = 1; node < index->capacity * 2; ++node) {
+        index->tree_max[node] = INT_MAX;
+        index->tree_min[node] = INT_MIN;
+    }
+    ggit_vector_clear(&index->slots);
+    ggit_vector_clear(&index->hulls);
+    ggit_vector_clear(&index->entries);
+}
+
+static void
+ggit_span_index_pull(struct ggit_span_index* index, int node)
+{
+    int const l = node * 2;
+    int const r = l + 1;
+    int const* tmax = index->tree_max;
+    int const* tmin = index->tree_min;
+    index->tree_max[node] = tmax[l] < tmax[r] ? tmax[l] : tmax[r];
+    index->tree_min[node] = tmin[l] > tmin[r] ? tmin[l] : tmin[r];
+}
+/* Opens the slot with the hull [merge_min, merge_max], INT_MAX / INT_MIN closes it. */
+static void
+ggit_span_index_set(struct ggit_span_index* index, int slot, int merge_max, int merge_min)
+{
+    int node = index->capacity + slot;
+    index->tree_max[node] = merge_max;
+    index->tree_min[node] = merge_min;
+    for (node >>= 1; node; node >>= 1)
+        ggit_span_index_pull(index, node);
+}
+static void
+ggit_span_index_grow(struct ggit_span_index* index)
+{
+    int const old_capacity = index->capacity;
+    int const capacity = old_capacity ? old_capacity * 2 : 16;
+    int* tree_max = (int*)malloc(capacity * 2 * sizeof(int));
+    int* tree_min = (int*)malloc(capacity * 2 * sizeof(int));
+    if (!tree_max || !tree_min) {
+        perror("[ggit_span_index_grow] OOM.");
+        abort();
+    }
+    for (int node = 0; node < capacity * 2; ++node) {
+        tree_max[node] = INT_MAX;
+        tree_min[node] = INT_MIN;
+    }
+    if (old_capacity) {
+        memcpy(tree_max + capacity, index->tree_max + old_capacity, old_capacity * sizeof(int));
+        memcpy(tree_min + capacity, index->tree_min + old_capacity, old_capacity * sizeof(int));
+    }
+    free(index->tree_max);
+    free(index->tree_min);
+    index->tree_max = tree_max;
+    index->tree_min = tree_min;
+    index->capacity = capacity;
+    for (int node = capacity - 1; node >= 1; --node)
+        ggit_span_index_pull(index, node);
+}
+/** Leftmost slot >= from with a hull ending at or below x, or starting at or above y. */
+static int
+ggit_span_index_search(
+    struct ggit_span_index const* index,
+    int node,
+    int node_begin,
+    int node_end,
+    int from,
+    int x,
+    int y
+)
+{
+    if (node_end <= from || (index->tree_max[node] > x && index->tree_min[node] < y))
+        return -1;
+    if (node_end - node_begin == 1)
+        return node_begin;
+
+    int const mid = node_begin + (node_end - node_begin) / 2;
+    int const slot = ggit_span_index_search(index, node * 2, node_begin, mid, from, x, y);
+    if (slot != -1)
+        return slot;
+    return ggit_span_index_search(index, node * 2 + 1, mid, node_end, from, x, y);
+}
+static int
+ggit_span_index_next_open(struct ggit_span_index const* index, int from)
+{
+    if (!index->capacity)
+        return -1;
+    return ggit_span_index_search(index, 1, 0, index->capacity, from, INT_MAX - 1, INT_MAX);
+}
+/** First open slot the span fits into, without colliding with its hull. -1 if none. O(log n). */
+int
+ggit_span_index_first_free(struct ggit_span_index const* index, struct ggit_column_span const* span)
+{
+    if (!index->capacity || !ggit_span_is_valid(span))
+        return -1;
+
+    /* NOTE(boz):
+        The same test as ggit_spans_collide(hull, span), for a valid hull: no collision
+        when the hull ends below the span (a tie on merge_max goes to the hull), or
+        starts at or above where the span ends.
+    */
+    int const x = span->merge_min < span->merge_max ? span->merge_min : span->merge_max - 1;
+    int const y = span->merge_max;
+    return ggit_span_index_search(index, 1, 0, index->capacity, 0, x, y);
+}
+/* Packs the next instance and returns its slot - pack = false keeps every instance in its own. */
+static int
+ggit_span_index_place(struct ggit_span_index* index, struct ggit_column_span const* span, bool pack)
+{
+    int const instance = index->size;
+    if (instance == index->capacity)
+        ggit_span_index_grow(index);
+    index->size += 1;
+    ggit_vector_push(&index->hulls, span);
+
+    int slot = instance;
+    bool const valid = ggit_span_is_valid(span);
+    if (valid && pack) {
+        int const free_slot = ggit_span_index_first_free(index, span);
+        if (free_slot != -1) {
+            slot = free_slot;
+            struct ggit_column_span* hull = (struct ggit_column_span*)index->hulls.data + slot;
+            ggit_spans_join(hull, span);
+            ggit_span_index_set(index, slot, hull->merge_max, hull->merge_min);
+
+            // The open slots it went past won't take anything anymore.
+            for (int s = ggit_span_index_next_open(index, slot + 1); s != -1 && s < instance;
+                 s = ggit_span_index_next_open(index, s + 1))
+                ggit_span_index_set(index, s, INT_MAX, INT_MIN);
+        } else {
+            ggit_span_index_set(index, slot, span->merge_max, span->merge_min);
+        }
+    }
+    ggit_vector_push(&index->slots, &slot);
+    return slot;
+}
+static int
+ggit_span_entry_compare(void const* a, void const* b)
+{
+    struct ggit_span_entry const* x = (struct ggit_span_entry const*)a;
+    struct ggit_span_entry const* y = (struct ggit_span_entry const*)b;
+    if (x->slot != y->slot)
+        return x->slot < y->slot ? -1 : 1;
+    if (x->merge_min != y->merge_min)
+        return x->merge_min < y->merge_min ? -1 : 1;
+    return (x->instance > y->instance) - (x->instance < y->instance);
+}
+/* First entry after everything in the slot starting at or below the commit. */
+static int
+ggit_span_index_upper_bound(struct ggit_span_index const* index, int slot, int commit)
+{
+    struct ggit_span_entry const* entries = (struct ggit_span_entry const*)index->entries.data;
+    int lo = 0;
+    int hi = index->entries.size;
+    while (lo < hi) {
+        int const mid = lo + (hi - lo) / 2;
+        if (entries[mid].slot < slot || (entries[mid].slot == slot && entries[mid].merge_min <= commit))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+/** Indexes all the spans of a branch from scratch. O(n log n). */
+void
+ggit_span_index_build(
+    struct ggit_span_index* index,
+    int count,
+    struct ggit_column_span const* spans,
+    bool pack
+)
+{
+    ggit_span_index_clear(index);
+    ggit_vector_reserve(&index->slots, count);
+    ggit_vector_reserve(&index->hulls, count);
+    for (int i = 0; i < count; ++i) {
+        int const slot = ggit_span_index_place(index, spans + i, pack);
+        if (ggit_span_is_valid(spans + i)) {
+            struct ggit_span_entry const entry = { slot, spans[i].merge_min, spans[i].merge_max, i };
+            ggit_vector_push(&index->entries, &entry);
+        }
+    }
+    if (index->entries.size)
+        qsort(
+            index->entries.data,
+            index->entries.size,
+            index->entries.value_size,
+            ggit_span_entry_compare
+        );
+}
+/** Instance whose span in the slot covers the commit, -1 if none. O(log n). */
+int
+ggit_span_index_find(struct ggit_span_index const* index, int slot, int commit)
+{
+    int const i = ggit_span_index_upper_bound(index, slot, commit);
+    if (i == 0)
+        return -1;
+    struct ggit_span_entry const* found = (struct ggit_span_entry const*)index->entries.data + i - 1;
+    return found->slot == slot && commit <= found->merge_max ? found->instance : -1;
+}
+size_t
+ggit_span_index_memory_usage(struct ggit_span_index const* index)
+{
+    size_t total = 0;
+    total += (size_t)index->capacity * 2 * 2 * sizeof(int);
+    total += (size_t)index->slots.capacity * index->slots.value_size;
+    total += (size_t)index->hulls.capacity * index->hulls.value_size;
+    total += (size_t)index->entries.capacity * index->entries.value_size;
+    return total;
+}
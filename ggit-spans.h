@@ -0,0 +1,70 @@
+#pragma once
+
+#include "ggit-vector.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+struct ggit_column_span
+{
+    int merge_min;
+    int commit_min;
+    int commit_max;
+    int merge_max;
+};
+
+/* An indexed span, entries are sorted by slot and then by where they start. */
+struct ggit_span_entry
+{
+    int slot;
+    int merge_min;
+    int merge_max;
+    int instance;
+};
+
+/** Interval index over the spans of one special branch, built in instance order.
+ *
+ * Packs the instances into slots (columns of the branch): an instance goes into the
+ * first open slot whose hull it doesn't collide with, otherwise it opens its own.
+ * Open slots an instance skipped over on its way to an earlier one are closed - the
+ * pairwise packing this replaces did the same, so the layout doesn't change.
+ *
+ * The hulls of the slots live in a segment tree - the lowest merge_max and the highest
+ * merge_min under every node - so the first free slot is found in O(log n). Entries
+ * sorted by slot and start answer "which instance is at this commit" with a binary search.
+ *
+ * The packing depends on the order, so a span that grows moves every instance after
+ * it - the index is rebuilt along with the spans, when the graph is (re)labeled.
+ */
+struct ggit_span_index
+{
+    int size;
+    /* Leaves of the tree, a power of two. Nodes are [1, 2 * capacity). */
+    int capacity;
+    int* tree_max; /* INT_MAX under nodes without open slots */
+    int* tree_min; /* INT_MIN under nodes without open slots */
+
+    /* [int]                     */ struct ggit_vector slots;   /* per instance */
+    /* [struct ggit_column_span] */ struct ggit_vector hulls;   /* per slot, slot = instance that opened it */
+    /* [struct ggit_span_entry]  */ struct ggit_vector entries;
+};
+
+// clang-format off
+bool   ggit_spans_collide            (struct ggit_column_span const* a, struct ggit_column_span const* b);
+void   ggit_spans_join               (struct ggit_column_span* restrict inout, struct ggit_column_span const* restrict in);
+
+void   ggit_span_index_init          (struct ggit_span_index* index);
+void   ggit_span_index_destroy       (struct ggit_span_index* index);
+void   ggit_span_index_clear         (struct ggit_span_index* index);
+void   ggit_span_index_build         (struct ggit_span_index* index, int count, struct ggit_column_span const* spans, bool pack);
+int    ggit_span_index_first_free    (struct ggit_span_index const* index, struct ggit_column_span const* span);
+int    ggit_span_index_find          (struct ggit_span_index const* index, int slot, int commit);
+size_t ggit_span_index_memory_usage  (struct ggit_span_index const* index);
+// clang-format on
+
+/* Slot (column inside of the branch) the instance was packed into. */
+static inline int
+ggit_span_index_slot(struct ggit_span_index const* index, int instance)
+{
+    return ((int const*)index->slots.data)[instance];
+}
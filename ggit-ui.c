@@ -53,6 +53,7 @@ ggit_ui_draw_rect_cut(
 
         // clang-format on
     };
+    ggit_profile_count_draw(ARRAY_COUNT(vertices));
     SDL_RenderGeometry(
         renderer,
         NULL,
@@ -113,7 +114,7 @@ ggit_ui_draw_arc(
         },
     };
 
-    SDL_RenderDrawLines(renderer, points, ARRAY_COUNT(points));
+    ggit_ui_draw_lines(renderer, points, ARRAY_COUNT(points));
 }
 void
 ggit_ui_draw_text(
@@ -137,6 +138,7 @@ ggit_ui_draw_text(
     );
     SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, text_surface);
     TTF_SizeUTF8(font, text, &out_opt_size->w, &out_opt_size->h);
+    ggit_profile_count_draw(4);
     SDL_RenderCopy(
         renderer,
         texture,
@@ -152,6 +154,91 @@ ggit_ui_draw_text(
     SDL_FreeSurface(text_surface);
 }
 
+void
+ggit_ui_batch_init(struct ggit_ui_batch* batch)
+{
+    ggit_vec_vertex_init(&batch->vertices);
+    ggit_vec_int_init(&batch->indices);
+}
+void
+ggit_ui_batch_destroy(struct ggit_ui_batch* batch)
+{
+    ggit_vec_vertex_destroy(&batch->vertices);
+    ggit_vec_int_destroy(&batch->indices);
+}
+void
+ggit_ui_batch_rect(
+    struct ggit_ui_batch* batch,
+    int x0,
+    int y0,
+    int x1,
+    int y1,
+    SDL_Color color
+)
+{
+    int const first = (int)batch->vertices.size;
+    SDL_Vertex* vertices = ggit_vec_vertex_extend(&batch->vertices, 4);
+    vertices[0] = (SDL_Vertex){ { x0, y0 }, color };
+    vertices[1] = (SDL_Vertex){ { x1, y0 }, color };
+    vertices[2] = (SDL_Vertex){ { x1, y1 }, color };
+    vertices[3] = (SDL_Vertex){ { x0, y1 }, color };
+
+    int* indices = ggit_vec_int_extend(&batch->indices, 6);
+    indices[0] = first + 0;
+    indices[1] = first + 1;
+    indices[2] = first + 2;
+    indices[3] = first + 0;
+    indices[4] = first + 2;
+    indices[5] = first + 3;
+}
+/** Draws everything collected so far in one call and empties the batch. */
+void
+ggit_ui_batch_flush(SDL_Renderer* renderer, struct ggit_ui_batch* batch)
+{
+    if (batch->indices.size) {
+        ggit_profile_count_draw((int)batch->vertices.size);
+        SDL_RenderGeometry(
+            renderer,
+            NULL,
+            batch->vertices.data,
+            (int)batch->vertices.size,
+            batch->indices.data,
+            (int)batch->indices.size
+        );
+    }
+    ggit_vec_vertex_clear(&batch->vertices);
+    ggit_vec_int_clear(&batch->indices);
+}
+
+/** Renders (possibly multi-line) text into a texture owned by the caller.
+ *
+ * Meant for text that is drawn many frames in a row - render once, SDL_RenderCopy often.
+ */
+SDL_Texture*
+ggit_ui_create_text_texture(
+    SDL_Renderer* renderer,
+    TTF_Font* font,
+    char const* text,
+    struct ggit_size* out_size
+)
+{
+    SDL_Surface* text_surface = TTF_RenderUTF8_LCD_Wrapped(
+        font,
+        text,
+        (SDL_Color){ 0x05, 0x05, 0x05, 0xFF },
+        (SDL_Color){ 220, 220, 220, 0xFF },
+        0
+    );
+    if (!text_surface)
+        return 0;
+
+    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, text_surface);
+    out_size->w = text_surface->w;
+    out_size->h = text_surface->h;
+    SDL_FreeSurface(text_surface);
+    return texture;
+}
+
 int
 ggit_ui_button(
     struct ggit_ui* ui,
@@ -1,7 +1,14 @@
 #pragma once
 
+#include "ggit-ancestry.h"
+#include "ggit-bitset.h"
+#include "ggit-filter.h"
 #include "ggit-graph.h"
+#include "ggit-lod.h"
+#include "ggit-profile.h"
+#include "ggit-search.h"
 #include "ggit-vector.h"
+#include "ggit-view.h"
 
 #include <SDL2/SDL_render.h>
 #include <SDL2/SDL_ttf.h>
@@ -13,12 +20,76 @@ struct ggit_size
     int w;
     int h;
 };
+GGIT_TYPED_VECTOR(size, struct ggit_size)
+GGIT_TYPED_VECTOR(texture, SDL_Texture*)
+
+/* Where a raw column is drawn - taken columns get consecutive new_x. */
+struct compressed_x
+{
+    short new_x;
+    bool taken;
+};
+GGIT_TYPED_VECTOR(compressed_x, struct compressed_x)
+
+/* Triangles collected over a pass and submitted with a single SDL_RenderGeometry. */
+GGIT_TYPED_VECTOR(vertex, SDL_Vertex)
+
+struct ggit_ui_batch
+{
+    struct ggit_vec_vertex vertices;
+    struct ggit_vec_int indices;
+};
+
+enum ggit_row_flags
+{
+    ggit_row_merge = 1 << 0,
+    ggit_row_ref = 1 << 1,
+    ggit_row_head = 1 << 2,
+    ggit_row_stash = 1 << 3,
+    /* Stands for a folded run, ggit_view_fold() says how long. */
+    ggit_row_fold = 1 << 4,
+};
+
+/** Everything the per-frame loops read about a row, 20 bytes, stored in row order.
+ *
+ * The commit's hash, author and times stay in the graph's own arrays - nothing
+ * drawn every frame needs them.
+ */
+struct ggit_row
+{
+    int commit;
+    /* Subject, in graph->message_store. 32 bits keep the row small and cap the
+       store at 4GiB of subjects - the loader asserts it stays under that. */
+    uint32_t message_offset;
+    /* Rows down to the first parent as the view sees it, 0 for none. */
+    int first_parent_delta;
+    /* Raw column, compressed_x says where it's drawn right now. */
+    uint16_t column;
+    short instance;
+    int8_t branch;
+    uint8_t flags; /* enum ggit_row_flags */
+};
+static_assert(sizeof(struct ggit_row) == 20, "struct ggit_row grew");
+GGIT_TYPED_VECTOR(row, struct ggit_row)
+
+enum ggit_prompt_kind
+{
+    ggit_prompt_none,
+    ggit_prompt_filter,
+    ggit_prompt_search,
+    ggit_prompt_jump,
+};
 
 struct ggit_ui
 {
     int screen_w;
     int screen_h;
 
+    /* Set whenever the next frame has to be drawn - input, reloads, animations. */
+    bool dirty;
+    /* --memory: print the memory report after every load and on exit. */
+    bool print_memory;
+
     int graph_x;
     int graph_y;
 
@@ -28,6 +99,9 @@ struct ggit_ui
     int margin_x;
     int margin_y;
 
+    /* Zoomed out past one pixel per row - every pixel row covers (1 << row_shift) rows. */
+    int row_shift;
+
     SDL_Renderer* renderer;
     TTF_Font* font;
 
@@ -38,16 +112,123 @@ struct ggit_ui
         int start_y;
         int end_x;
         int end_y;
+
+        /* Last picked commit, and the fixed end of shift-click ranges. -1 if none. */
         int active_commit;
-        struct ggit_vector selected_commits;
+        int anchor_commit;
+
+        /* One bit per commit - membership is O(1), ranges are set a word at a time. */
+        struct ggit_bitset selected;
+        /* [int] Commits picked by clicking, in the order they were picked. */
+        struct ggit_vector picked;
+
+        /* graph->revision the bitset was sized for. */
+        int graph_revision;
     } select;
 
+    /* The filtered graph - what the rows on screen actually are. */
+    struct ggit_view view;
+
+    struct filter
+    {
+        struct ggit_filter spec;
+        struct ggit_filter_index index;
+        /* Commits passing the filter. */
+        struct ggit_bitset commits;
+        /* spec changed since the view was built. */
+        bool dirty;
+        /* Fold long linear runs into one row (F8). */
+        bool fold;
+    } filter;
+
+    struct search
+    {
+        struct ggit_search engine;
+        char query[256];
+        /* Matches streamed in from the workers so far, one bit per commit. */
+        struct ggit_bitset matches;
+        bool running;
+        /* Where next/previous navigation is, -1 before the first step. */
+        int current;
+    } search;
+
+    struct ancestry
+    {
+        struct ggit_ancestry engine;
+        /* Commit of the clicked ref whose history is highlighted, -1 for none. */
+        int root;
+        /* Highlight what was built on top of root instead (Ctrl+D). */
+        bool descendants;
+        int graph_revision;
+
+        /* [int8_t] Per ref: does it contain contains_commit? -1 = not asked yet. */
+        int contains_commit;
+        struct ggit_vector contains;
+    } ancestry;
+
+    /* Single line text input at the bottom of the screen. */
+    struct prompt
+    {
+        enum ggit_prompt_kind kind;
+        char text[256];
+        int length;
+        bool error;
+        /* Why the last submit failed, shown next to the label. */
+        char const* message;
+    } prompt;
+
     struct cache
     {
+        /* graph->revision the raw columns were built for, view.serial the rest. */
+        int graph_revision;
+        int view_serial;
+
         int compressed_width;
-        struct ggit_vector compressed_x; /* int */
+        struct ggit_vec_compressed_x compressed_x; /* per raw column */
+        struct ggit_vec_int columns;               /* uncompressed column of every commit */
+        struct ggit_vec_int branch_column;         /* first raw column of every special branch */
+        struct ggit_vec_int branch_order;          /* special branches by their first column */
+        struct ggit_vec_row rows;                  /* one per visible row */
+
+        /* NOTE(boz):
+            Viewport compression - a column only takes space while one of the rows
+            on screen uses it. occupancy counts the commits of every raw column
+            inside rows [window_from, window_to), updated as rows scroll in and out.
+        */
+        bool compress_viewport;
+        int window_from;
+        int window_to;
+        struct ggit_vec_int occupancy;
+
+        /* Columns slide to their new place instead of jumping there. */
+        struct ggit_vec_f32 column_x;      /* animated position of every raw column */
+        struct ggit_vec_int column_offset; /* pixels added to a compressed column */
+        float width_x;
+        uint64_t animated_at;
+
+        struct ggit_lod lod;
     } cache;
 
+    struct ggit_ui_batch batch;
+
+    /* Ref labels - measured once per graph, rendered when they first come on screen. */
+    struct labels
+    {
+        int graph_revision;
+        struct ggit_vec_size sizes;       /* per ref, w = -1 until measured */
+        struct ggit_vec_texture textures; /* per ref, 0 until rendered */
+        int n_textures;
+        size_t texture_bytes;
+    } labels;
+
+    /* Profiler overlay - the text is re-rendered a few times a second, not per frame. */
+    struct hud
+    {
+        SDL_Texture* text;
+        struct ggit_size text_size;
+        uint64_t refreshed_at;
+    } hud;
+
     /*
     =============
     Windows
@@ -68,6 +249,7 @@ struct ggit_input
     unsigned buttons[5];
 
     bool is_ctrl_down;
+    bool is_shift_down;
 };
 /*
 ===============
@@ -99,6 +281,36 @@ void ggit_ui_draw_text(
     int y,
     struct ggit_size* out_opt_size
 );
+SDL_Texture* ggit_ui_create_text_texture(
+    SDL_Renderer* renderer,
+    TTF_Font* font,
+    char const* text,
+    struct ggit_size* out_size
+);
+static inline void
+ggit_ui_draw_line(SDL_Renderer* renderer, int x0, int y0, int x1, int y1)
+{
+    ggit_profile_count_draw(2);
+    SDL_RenderDrawLine(renderer, x0, y0, x1, y1);
+}
+static inline void
+ggit_ui_draw_lines(SDL_Renderer* renderer, SDL_Point const* points, int count)
+{
+    ggit_profile_count_draw(count);
+    SDL_RenderDrawLines(renderer, points, count);
+}
+
+void ggit_ui_batch_init(struct ggit_ui_batch* batch);
+void ggit_ui_batch_destroy(struct ggit_ui_batch* batch);
+void ggit_ui_batch_rect(
+    struct ggit_ui_batch* batch,
+    int x0,
+    int y0,
+    int x1,
+    int y1,
+    SDL_Color color
+);
+void ggit_ui_batch_flush(SDL_Renderer* renderer, struct ggit_ui_batch* batch);
 
 /*
 ===============
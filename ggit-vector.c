@@ -6,53 +6,68 @@
 #include <string.h>
 #include <assert.h>
 
-static bool
-ggit_realloc(void** data_block, int element_size, int old_elements, int new_elements)
+/** Capacity after growing to at least `at_least` values - 2x while small, 1.5x after that.
+ *
+ * Everything pushed one at a time ends up here O(log n) times, reserves get what
+ * they asked for if that's more than the growth step.
+ */
+size_t
+ggit_vec_next_capacity(size_t capacity, size_t at_least)
 {
-    void* old_block = *data_block;
-    void* new_block = realloc(old_block, new_elements * element_size);
-    if (!new_block) {
-        new_block = calloc(old_elements, element_size);
-        if (!new_block) {
-            return false;
-        } else {
-            memcpy(new_block, old_block, old_elements * element_size);
-            free(old_block);
-        }
+    size_t new_capacity = capacity < 4096 ? capacity * 2 : capacity + capacity / 2;
+    if (new_capacity < 8)
+        new_capacity = 8;
+    if (new_capacity < at_least)
+        new_capacity = at_least;
+    return new_capacity;
+}
+void
+ggit_vec_grow(void** data, size_t* capacity, size_t value_size, size_t at_least)
+{
+    size_t const new_capacity = ggit_vec_next_capacity(*capacity, at_least);
+    void* block = realloc(*data, new_capacity * value_size);
+    if (!block) {
+        perror("[ggit_vec_grow] OOM.");
+        abort();
     }
-    printf("ReAlloc: %p %d->%d\n", *data_block, old_elements, new_elements);
-
-    *data_block = new_block;
-    return true;
+    *data = block;
+    *capacity = new_capacity;
 }
-static void
-ggit_vector_grow(struct ggit_vector* vec, int more, bool exact)
+void
+ggit_vec_shrink(void** data, size_t* capacity, size_t value_size, size_t size)
 {
-    int old_capacity = vec->capacity;
-    int new_capacity;
-    if (more == 1 && old_capacity == 0)
-        new_capacity = 8;
-    else {
-        /* TODO(boz):
-            INEFFICIENT! Make two different versions of grow(), one for
-            resize/reserve/reserve_more and one for insert/push.
-        */
-        if (exact) {
-            new_capacity = old_capacity + more;
-        } else {
-            new_capacity = old_capacity + old_capacity;
-            do {
-                new_capacity += old_capacity;
-            } while (new_capacity < old_capacity + more);
-        }
+    if (!size) {
+        free(*data);
+        *data = 0;
+        *capacity = 0;
+        return;
     }
-
-    if (!ggit_realloc(&vec->data, vec->value_size, vec->size, new_capacity)) {
-        perror("[ggit_vector_grow] OOM.");
+    void* block = realloc(*data, size * value_size);
+    if (!block) {
+        perror("[ggit_vec_shrink] OOM.");
         abort();
-    } else {
-        vec->capacity = new_capacity;
     }
+    *data = block;
+    *capacity = size;
+}
+static void
+ggit_vector_grow(struct ggit_vector* vec, int at_least)
+{
+    size_t const value_size = (size_t)vec->value_size;
+    if (!vec->allocator) {
+        size_t capacity = (size_t)vec->capacity;
+        ggit_vec_grow(&vec->data, &capacity, value_size, (size_t)at_least);
+        vec->capacity = (int)capacity;
+        return;
+    }
+    size_t const capacity = ggit_vec_next_capacity((size_t)vec->capacity, (size_t)at_least);
+    vec->data = vec->allocator->realloc(
+        vec->allocator->ctx,
+        vec->data,
+        (size_t)vec->capacity * value_size,
+        capacity * value_size
+    );
+    vec->capacity = (int)capacity;
 }
 
 void
@@ -62,10 +77,24 @@ ggit_vector_init(struct ggit_vector* vec, int value_size)
     assert(vec->size == 0);
     vec->value_size = value_size;
 }
+/** A vector growing through `allocator` - it has to outlive the vector. */
+void
+ggit_vector_init_with(struct ggit_vector* vec, int value_size, struct ggit_allocator const* allocator)
+{
+    ggit_vector_init(vec, value_size);
+    vec->allocator = allocator;
+}
 void
 ggit_vector_destroy(struct ggit_vector* vec)
 {
-    free(vec->data);
+    if (vec->allocator)
+        vec->allocator->free(
+            vec->allocator->ctx,
+            vec->data,
+            (size_t)vec->capacity * vec->value_size
+        );
+    else
+        free(vec->data);
     memset(vec, 0, sizeof(*vec));
 }
 void
@@ -93,7 +122,7 @@ ggit_vector_insert(struct ggit_vector* vec, int index, void const* value)
     assert(index <= size);
 
     if (size + 1 > vec->capacity)
-        ggit_vector_grow(vec, 1, false);
+        ggit_vector_grow(vec, size + 1);
 
     int move_amount = size - index;
     if (move_amount) {
@@ -110,23 +139,30 @@ ggit_vector_insert(struct ggit_vector* vec, int index, void const* value)
 void
 ggit_vector_push(struct ggit_vector* vec, void const* value)
 {
-    ggit_vector_insert(vec, vec->size, value);
+    if (vec->size == vec->capacity)
+        ggit_vector_grow(vec, vec->size + 1);
+    memcpy((char*)vec->data + (size_t)vec->value_size * vec->size, value, vec->value_size);
+    vec->size += 1;
 }
 void
 ggit_vector_reserve(struct ggit_vector* vec, int at_least)
 {
-    int more = at_least - vec->capacity;
-    if (more > 0)
-        ggit_vector_grow(vec, more, true);
+    if (at_least > vec->capacity)
+        ggit_vector_grow(vec, at_least);
 }
 void
 ggit_vector_reserve_more(struct ggit_vector* vec, int more)
 {
-    if (more > 0)
-        ggit_vector_grow(vec, more, true);
+    if (more > 0 && vec->size + more > vec->capacity)
+        ggit_vector_grow(vec, vec->size + more);
 }
 void*
 ggit_vector_get(struct ggit_vector* vec, int index)
 {
     return (char*)vec->data + (vec->value_size * index);
-}
\ No newline at end of file
+}
+size_t
+ggit_vector_memory_usage(struct ggit_vector const* vec)
+{
+    return (size_t)vec->capacity * vec->value_size;
+}
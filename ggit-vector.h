@@ -1,8 +1,12 @@
 #ifndef GGIT_VECTOR_H
 #define GGIT_VECTOR_H
 
+#include "ggit-arena.h"
+
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
+#include <stdlib.h>
 
 struct ggit_vector
 {
@@ -10,20 +14,100 @@ struct ggit_vector
     int capacity;
     int value_size;
     void* data;
+    /* Where data comes from, 0 is the heap. */
+    struct ggit_allocator const* allocator;
 };
 
 // clang-format off
-void  ggit_vector_init        (struct ggit_vector* vec, int value_size);
-void  ggit_vector_destroy     (struct ggit_vector* vec);
-void  ggit_vector_clear       (struct ggit_vector* vec);
-void  ggit_vector_clear_and_free(struct ggit_vector* vec);
-void  ggit_vector_insert      (struct ggit_vector* vec, int index, void const* value);
-void  ggit_vector_push        (struct ggit_vector* vec, void const* value);
-void  ggit_vector_reserve     (struct ggit_vector* vec, int at_least);
-void  ggit_vector_reserve_more(struct ggit_vector* vec, int more);
-void* ggit_vector_get         (struct ggit_vector* vec, int index);
+void   ggit_vector_init          (struct ggit_vector* vec, int value_size);
+void   ggit_vector_init_with     (struct ggit_vector* vec, int value_size, struct ggit_allocator const* allocator);
+void   ggit_vector_destroy       (struct ggit_vector* vec);
+void   ggit_vector_clear         (struct ggit_vector* vec);
+void   ggit_vector_clear_and_free(struct ggit_vector* vec);
+void   ggit_vector_insert        (struct ggit_vector* vec, int index, void const* value);
+void   ggit_vector_push          (struct ggit_vector* vec, void const* value);
+void   ggit_vector_reserve       (struct ggit_vector* vec, int at_least);
+void   ggit_vector_reserve_more  (struct ggit_vector* vec, int more);
+void*  ggit_vector_get           (struct ggit_vector* vec, int index);
+size_t ggit_vector_memory_usage  (struct ggit_vector const* vec);
+
+void   ggit_vec_grow             (void** data, size_t* capacity, size_t value_size, size_t at_least);
+void   ggit_vec_shrink           (void** data, size_t* capacity, size_t value_size, size_t size);
+size_t ggit_vec_next_capacity    (size_t capacity, size_t at_least);
 // clang-format on
 
+/* NOTE(boz):
+    Typed vectors - GGIT_TYPED_VECTOR(name, type) declares struct ggit_vec_<name> and
+    its functions, all inline. Sizes are size_t, push is a compare and a store, only
+    growing goes out of line (ggit_vec_grow: 2x while small, 1.5x after that).
+
+    The untyped ggit_vector stays for the cold places, anything pushed per commit or
+    per frame should use one of these.
+*/
+#define GGIT_TYPED_VECTOR(name, type)                                                    \
+    struct ggit_vec_##name                                                               \
+    {                                                                                    \
+        type* data;                                                                      \
+        size_t size;                                                                     \
+        size_t capacity;                                                                 \
+    };                                                                                   \
+    static inline void ggit_vec_##name##_init(struct ggit_vec_##name* vec)               \
+    {                                                                                    \
+        vec->data = 0;                                                                   \
+        vec->size = 0;                                                                   \
+        vec->capacity = 0;                                                               \
+    }                                                                                    \
+    static inline void ggit_vec_##name##_destroy(struct ggit_vec_##name* vec)            \
+    {                                                                                    \
+        free(vec->data);                                                                 \
+        ggit_vec_##name##_init(vec);                                                     \
+    }                                                                                    \
+    static inline void ggit_vec_##name##_clear(struct ggit_vec_##name* vec)              \
+    {                                                                                    \
+        vec->size = 0;                                                                   \
+    }                                                                                    \
+    static inline void ggit_vec_##name##_reserve(struct ggit_vec_##name* vec, size_t n)  \
+    {                                                                                    \
+        if (n > vec->capacity)                                                           \
+            ggit_vec_grow((void**)&vec->data, &vec->capacity, sizeof(type), n);          \
+    }                                                                                    \
+    /* Gives back the capacity past size, for vectors that won't grow anymore. */       \
+    static inline void ggit_vec_##name##_shrink(struct ggit_vec_##name* vec)             \
+    {                                                                                    \
+        if (vec->capacity > vec->size)                                                   \
+            ggit_vec_shrink((void**)&vec->data, &vec->capacity, sizeof(type), vec->size); \
+    }                                                                                    \
+    static inline void ggit_vec_##name##_push(struct ggit_vec_##name* vec, type value)   \
+    {                                                                                    \
+        if (vec->size == vec->capacity)                                                  \
+            ggit_vec_grow((void**)&vec->data, &vec->capacity, sizeof(type), vec->size + 1); \
+        vec->data[vec->size++] = value;                                                  \
+    }                                                                                    \
+    /* n more elements at the end, left for the caller to fill. */                       \
+    static inline type* ggit_vec_##name##_extend(struct ggit_vec_##name* vec, size_t n)  \
+    {                                                                                    \
+        ggit_vec_##name##_reserve(vec, vec->size + n);                                   \
+        type* first = vec->data + vec->size;                                             \
+        vec->size += n;                                                                  \
+        return first;                                                                    \
+    }                                                                                    \
+    static inline type ggit_vec_##name##_get(struct ggit_vec_##name const* vec, size_t i) \
+    {                                                                                    \
+        return vec->data[i];                                                             \
+    }                                                                                    \
+    static inline size_t ggit_vec_##name##_memory_usage(struct ggit_vec_##name const* vec) \
+    {                                                                                    \
+        return vec->capacity * sizeof(type);                                             \
+    }
+
+GGIT_TYPED_VECTOR(char, char)
+GGIT_TYPED_VECTOR(int, int)
+GGIT_TYPED_VECTOR(u16, uint16_t)
+GGIT_TYPED_VECTOR(u32, uint32_t)
+GGIT_TYPED_VECTOR(i64, int64_t)
+GGIT_TYPED_VECTOR(f32, float)
+GGIT_TYPED_VECTOR(string, char*)
+
 
 #define GGIT_GENERATE_VECTOR_REF_GETTER(type, name)                         \
     inline type* ggit_vector_ref_##name(struct ggit_vector* vec, int index) \
@@ -0,0 +1,255 @@
+#include "ggit-view.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+static void*
+ggit_view_alloc(size_t count, size_t size)
+{
+    void* block = malloc((count ? count : 1) * size);
+    if (!block) {
+        perror("[ggit_view_build] OOM.");
+        abort();
+    }
+    return block;
+}
+static void
+ggit_view_free_filtered(struct ggit_view* view)
+{
+    if (view->filtered) {
+        free(view->ranks);
+        free(view->reach);
+    }
+    view->ranks = 0;
+    view->parents = 0;
+    view->reach = 0;
+    view->filtered = false;
+}
+
+void
+ggit_view_init(struct ggit_view* view)
+{
+    memset(view, 0, sizeof(*view));
+    view->revision = -1;
+    ggit_bitset_init(&view->visible);
+    ggit_parents_init(&view->rewired);
+    ggit_vector_init(&view->folds, sizeof(struct ggit_fold));
+}
+void
+ggit_view_destroy(struct ggit_view* view)
+{
+    ggit_view_free_filtered(view);
+    ggit_bitset_destroy(&view->visible);
+    ggit_parents_destroy(&view->rewired);
+    ggit_vector_destroy(&view->folds);
+    memset(view, 0, sizeof(*view));
+    view->revision = -1;
+}
+/* Commit c continues a run started by c - 1: same instance, c - 1 its only parent. */
+static bool
+ggit_view_continues_run(struct ggit_graph const* graph, int c)
+{
+    struct ggit_commit_tag const a = graph->tags[c - 1];
+    struct ggit_commit_tag const b = graph->tags[c];
+    return ggit_parents_count(&graph->parents, c) == 1 && a.tag[0] == b.tag[0]
+           && a.tag[1] == b.tag[1];
+}
+/* Nothing else hangs off the commit - at most one parent and one child, no refs. */
+static bool
+ggit_view_is_plain(struct ggit_graph const* graph, int c)
+{
+    int n_children;
+    int n_refs;
+    ggit_graph_children(graph, c, &n_children);
+    ggit_graph_commit_refs(graph, c, &n_refs);
+    return ggit_parents_count(&graph->parents, c) <= 1 && n_children <= 1 && n_refs == 0;
+}
+/** Hides all but the newest commit of every foldable run of at least `fold_min` commits.
+ *
+ * Runs only live inside of first-parent chains, so this walks the chains and never
+ * looks a parent up. Only commits that are still visible take part.
+ */
+static void
+ggit_view_fold_runs(struct ggit_view* view, struct ggit_graph const* graph, int fold_min)
+{
+    for (int ch = 0; ch < graph->n_chains; ++ch) {
+        int const begin = graph->chain_starts[ch];
+        int const end = graph->chain_starts[ch + 1];
+        for (int lo = begin; lo < end;) {
+            if (!ggit_bitset_test(&view->visible, lo) || !ggit_view_is_plain(graph, lo)) {
+                ++lo;
+                continue;
+            }
+
+            /* NOTE(boz):
+                Every commit but the newest of the run gets hidden, so they must be
+                plain. The newest keeps its children and only has to be free of refs,
+                which would otherwise get drawn on the fold.
+            */
+            int hi = lo;
+            while (hi + 1 < end && ggit_bitset_test(&view->visible, hi + 1)
+                   && ggit_view_continues_run(graph, hi + 1)) {
+                ++hi;
+                if (!ggit_view_is_plain(graph, hi))
+                    break;
+            }
+            int n_refs;
+            ggit_graph_commit_refs(graph, hi, &n_refs);
+            if (n_refs)
+                --hi;
+
+            int const count = hi - lo + 1;
+            if (count > 1 && count >= fold_min) {
+                ggit_bitset_clear_range(&view->visible, lo, hi);
+                struct ggit_fold const fold = { hi, count };
+                ggit_vector_push(&view->folds, &fold);
+            }
+            lo = hi + 1;
+        }
+    }
+}
+
+/** Rebuilds the view of the graph, showing the commits in `visible` (NULL = all). O(commits).
+ *
+ * fold_min > 0 folds the linear runs at least that long, 0 leaves them alone.
+ */
+void
+ggit_view_build(
+    struct ggit_view* view,
+    struct ggit_graph const* graph,
+    struct ggit_bitset const* visible,
+    int fold_min
+)
+{
+    ggit_view_free_filtered(view);
+    ggit_vector_clear(&view->folds);
+    view->revision = graph->revision;
+    view->serial += 1;
+
+    int const g_height = graph->height;
+    if (!visible && fold_min <= 0) {
+        view->height = g_height;
+        view->parents = &graph->parents;
+        view->reach = graph->reach;
+        return;
+    }
+
+    view->filtered = true;
+    if (visible) {
+        ggit_bitset_copy(&view->visible, visible);
+    } else {
+        ggit_bitset_resize(&view->visible, g_height);
+        ggit_bitset_clear(&view->visible);
+        ggit_bitset_set_range(&view->visible, 0, g_height);
+    }
+    if (fold_min > 0)
+        ggit_view_fold_runs(view, graph, fold_min);
+
+    int const n_words = ggit_bitset_words(g_height);
+    view->ranks = (uint32_t*)ggit_view_alloc(n_words + 1, sizeof(uint32_t));
+    uint32_t rank = 0;
+    for (int w = 0; w < n_words; ++w) {
+        view->ranks[w] = rank;
+        rank += ggit_popcount64(view->visible.words[w]);
+    }
+    view->ranks[n_words] = rank;
+    view->height = (int)rank;
+
+    /* NOTE(boz):
+        nearest[c] - c itself if visible, otherwise the nearest visible commit down
+        its first-parent chain. Parents are always older, so one pass suffices.
+    */
+    int* nearest = (int*)ggit_view_alloc(g_height, sizeof(int));
+    for (int c = 0; c < g_height; ++c) {
+        int const p0 = ggit_parents_first(&graph->parents, c);
+        if (ggit_bitset_test(&view->visible, c))
+            nearest[c] = c;
+        else
+            nearest[c] = p0 == -1 ? -1 : nearest[p0];
+    }
+
+    struct ggit_parents* rewired = &view->rewired;
+    ggit_parents_clear(rewired);
+    ggit_parents_reserve(rewired, g_height, view->height);
+    for (int c = 0; c < g_height; ++c) {
+        if (nearest[c] != c) {
+            ggit_parents_end_commit(rewired);
+            continue;
+        }
+
+        size_t const first = rewired->parents.size;
+        int n_parents;
+        int const* parents = ggit_parents_of(&graph->parents, c, &n_parents);
+        for (int j = 0; j < n_parents; ++j) {
+            int const p = nearest[parents[j]];
+            if (p == -1)
+                continue;
+
+            // Two parents can lead to the same visible commit.
+            bool seen = false;
+            for (size_t k = first; k < rewired->parents.size; ++k)
+                seen |= rewired->parents.data[k] == p;
+            if (!seen)
+                ggit_vec_int_push(&rewired->parents, p);
+        }
+        ggit_parents_end_commit(rewired);
+    }
+    free(nearest);
+
+    view->parents = rewired;
+    view->reach = ggit_compute_reach(rewired);
+}
+/** The k-th oldest visible commit, k in [0, height). */
+int
+ggit_view_select(struct ggit_view const* view, int k)
+{
+    int const n_words = ggit_bitset_words(view->visible.size);
+
+    // Last word with fewer than k + 1 visible commits before it.
+    int lo = 0;
+    int hi = n_words - 1;
+    while (lo < hi) {
+        int const mid = lo + (hi - lo + 1) / 2;
+        if (view->ranks[mid] <= (uint32_t)k)
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+
+    uint64_t word = view->visible.words[lo];
+    for (int skip = k - (int)view->ranks[lo]; skip > 0; --skip)
+        word &= word - 1;
+    assert(word);
+    return (lo << 6) + ggit_ctz64(word);
+}
+/** Number of commits folded into the commit's row, 0 if it isn't a fold. O(log folds). */
+int
+ggit_view_fold(struct ggit_view const* view, int commit)
+{
+    struct ggit_fold const* folds = (struct ggit_fold const*)view->folds.data;
+    int lo = 0;
+    int hi = view->folds.size;
+    while (lo < hi) {
+        int const mid = lo + (hi - lo) / 2;
+        if (folds[mid].commit < commit)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo < view->folds.size && folds[lo].commit == commit ? folds[lo].count : 0;
+}
+size_t
+ggit_view_memory_usage(struct ggit_view const* view)
+{
+    size_t total = 0;
+    total += ggit_bitset_memory_usage(&view->visible);
+    total += ggit_parents_memory_usage(&view->rewired);
+    total += (size_t)view->folds.capacity * view->folds.value_size;
+    if (view->filtered) {
+        total += (size_t)(ggit_bitset_words(view->visible.size) + 1) * sizeof(*view->ranks);
+        total += (size_t)view->visible.size * sizeof(*view->reach);
+    }
+    return total;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "ggit-bitset.h"
+#include "ggit-graph.h"
+
+#include <stdint.h>
+
+/* Linear runs of at least this many commits fold into one row. */
+#define GGIT_VIEW_FOLD_MIN 16
+
+/* A folded run - `commit` (the newest of the run) is drawn for all `count` commits. */
+struct ggit_fold
+{
+    int commit;
+    int count;
+};
+
+/** The graph as it is drawn - only the commits that pass the filter.
+ *
+ * Rows are counted from the newest visible commit. Hidden commits are skipped by
+ * rewiring every parent to its nearest visible ancestor on the first-parent chain.
+ * Without a filter every call is the identity and nothing is allocated.
+ *
+ * Folding hides long linear runs the same way: a run of commits on one instance,
+ * one parent and one child each, no refs, keeps only its newest commit, drawn as
+ * a "... k commits ..." row. The rows stay a rank/select over the visible bitset.
+ */
+struct ggit_view
+{
+    /* Graph revision the view was built for. */
+    int revision;
+    /* Bumped on every rebuild, so caches derived from the rows know to rebuild. */
+    int serial;
+
+    bool filtered;
+    int height;
+
+    /* Visible commits, and the number of them before every word of the bitset. */
+    struct ggit_bitset visible;
+    uint32_t* ranks;
+
+    /* &graph->parents and graph->reach when not filtered, otherwise &rewired and our own. */
+    struct ggit_parents const* parents;
+    int* reach;
+    struct ggit_parents rewired;
+
+    /* [struct ggit_fold] Sorted by commit. */
+    struct ggit_vector folds;
+};
+
+// clang-format off
+void   ggit_view_init        (struct ggit_view* view);
+void   ggit_view_destroy     (struct ggit_view* view);
+void   ggit_view_build       (struct ggit_view* view, struct ggit_graph const* graph, struct ggit_bitset const* visible, int fold_min);
+int    ggit_view_select      (struct ggit_view const* view, int k);
+int    ggit_view_fold        (struct ggit_view const* view, int commit);
+size_t ggit_view_memory_usage(struct ggit_view const* view);
+// clang-format on
+
+/* Visible commits older than `commit`. */
+static inline int
+ggit_view_rank(struct ggit_view const* view, int commit)
+{
+    if (!view->filtered)
+        return commit;
+    int const word = commit >> 6;
+    uint64_t const below = ((uint64_t)1 << (commit & 63)) - 1;
+    return (int)view->ranks[word] + ggit_popcount64(view->visible.words[word] & below);
+}
+/* Row of the commit. A hidden commit gets the row of the next newer visible one. */
+static inline int
+ggit_view_row(struct ggit_view const* view, int commit)
+{
+    return view->height - 1 - ggit_view_rank(view, commit);
+}
+/* Commit drawn on the row. */
+static inline int
+ggit_view_commit(struct ggit_view const* view, int row)
+{
+    int const k = view->height - 1 - row;
+    if (!view->filtered)
+        return k;
+    return ggit_view_select(view, k);
+}
+static inline bool
+ggit_view_is_visible(struct ggit_view const* view, int commit)
+{
+    return !view->filtered || ggit_bitset_test(&view->visible, commit);
+}
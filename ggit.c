@@ -10,6 +10,8 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <string.h>
+#include <math.h>
+#include <ctype.h>
 #include <assert.h>
 
 #include "ggit-vector.h"
@@ -23,12 +25,25 @@
 
 #define ARRAY_COUNT(array) ARRAYSIZE(array)
 
-struct compressed_x
-{
-    short new_x;
-    bool taken;
-};
-GGIT_GENERATE_VECTOR_GETTERS(struct compressed_x, compressed_x)
+/* How long an idle window sleeps before checking for work again. */
+#define GGIT_IDLE_WAIT_MS 250
+/* How often the profiler HUD re-renders its text. */
+#define GGIT_HUD_REFRESH_MS 250
+
+/* Rows shorter than this switch the graph to level-of-detail drawing. */
+#define GGIT_LOD_ROW_PX 6
+/* Smallest height of an LOD density band. */
+#define GGIT_LOD_BAND_PX 3
+/* Zooming out stops at (1 << GGIT_MAX_ROW_SHIFT) rows per pixel. */
+#define GGIT_MAX_ROW_SHIFT 24
+/* A wheel notch scrolls at least this far, even when rows are tiny. */
+#define GGIT_SCROLL_MIN_PX 24
+/* Columns moving to a new compressed position cover half the distance in this time. */
+#define GGIT_COLUMN_HALF_LIFE_MS 40.0f
+/* Rendered ref labels kept at once - all of them are dropped when there are more. */
+#define GGIT_LABEL_TEXTURES 512
+/* Special branches and extra merge formats, see ggit_graph_load_config. */
+#define GGIT_BRANCH_CONFIG "res/branches.cfg"
 
 /* TODO:
     Use this instead of _popen in ggit_graph_load();
@@ -163,159 +178,128 @@ error_stdin:;
 }
 
 
-static bool
-spans_collide(
-    struct ggit_column_span const* restrict a,
-    struct ggit_column_span const* restrict b
+/** First raw column of every branch - right growing branches go after the left growing ones.
+ *
+ * out_order gets the branches sorted by that column, for going from a column back
+ * to its branch with a binary search. O(branches).
+ */
+static void
+ggit_graph_branch_columns(
+    struct ggit_graph* graph,
+    struct ggit_vec_int* out_columns,
+    struct ggit_vec_int* out_order
 )
 {
-    int am_min = a->merge_min;
-    int am_max = a->merge_max;
-    int bm_min = b->merge_min;
-    int bm_max = b->merge_max;
+    int const n_branches = graph->special_branches.size;
+    ggit_vec_int_clear(out_columns);
+    ggit_vec_int_clear(out_order);
+    ggit_vec_int_extend(out_columns, (size_t)n_branches);
+    ggit_vec_int_reserve(out_order, (size_t)n_branches);
 
-    if (bm_min == -1 && bm_max == -1)
-        return false;
-
-    if ((am_min | am_max | bm_min | bm_max) < 0)
-        return true;
-
-    if (am_min > am_max) {
-        return true;
-    }
-    if (bm_min > bm_max) {
-        return true;
+    int column = 0;
+    for (int pass = 0; pass < 2; ++pass) {
+        for (int i = 0; i < n_branches; ++i) {
+            struct ggit_special_branch* i_branch = ggit_vector_ref_special_branch(
+                &graph->special_branches,
+                i
+            );
+            bool const grows_left = i_branch->growth_direction < 0;
+            if (grows_left != (pass == 0))
+                continue;
+            out_columns->data[i] = column;
+            ggit_vec_int_push(out_order, i);
+            column += i_branch->instances.size;
+        }
     }
-
-    if (am_max < bm_max)
-        return spans_collide(b, a);
-
-    /*
-        From this point on
-        A always reaches "higher" than B.
-    */
-
-    return am_min < bm_max;
 }
-
-static void
-spans_join(
-    struct ggit_column_span* restrict inout,
-    struct ggit_column_span const* restrict in
-)
+/* Branch owning the raw column, -1 if none. O(log branches). */
+static int
+ggit_ui_column_branch(struct ggit_ui* ui, struct ggit_graph* graph, int column)
 {
-    inout->commit_min = min(inout->commit_min, in->commit_min);
-    inout->commit_max = max(inout->commit_max, in->commit_max);
-    inout->merge_min = min(inout->merge_min, in->merge_min);
-    inout->merge_max = max(inout->merge_max, in->merge_max);
+    int const* first = ui->cache.branch_column.data;
+    int const* order = ui->cache.branch_order.data;
+
+    /* Branches without instances start where the next one does, the last one wins. */
+    int lo = 0;
+    int hi = (int)ui->cache.branch_order.size;
+    while (lo < hi) {
+        int const mid = (lo + hi) / 2;
+        if (first[order[mid]] <= column)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (lo == 0)
+        return -1;
+    int const branch = order[lo - 1];
+    struct ggit_special_branch* sb = ggit_vector_ref_special_branch(
+        &graph->special_branches,
+        branch
+    );
+    return column - first[branch] < sb->instances.size ? branch : -1;
 }
 static int
 ggit_graph_commit_column(
     struct ggit_graph* graph,
-    struct ggit_vector* compressed_x,
+    int const* branch_column,
+    struct ggit_vec_compressed_x* compressed_x,
     int commit_index
 )
 {
     struct ggit_commit_tag const tag = graph->tags[commit_index];
-    int const branch = tag.tag[0];
-    int index = tag.tag[1];
     struct ggit_special_branch* commit_branch = ggit_vector_ref_special_branch(
         &graph->special_branches,
-        branch
-    );
-    struct ggit_column_span* commit_branch_span = ggit_vector_ref_column_span(
-        &commit_branch->spans,
-        index
+        tag.tag[0]
     );
 
-    int column = 0;
-    bool stop = false;
-
-    if (commit_branch->growth_direction >= 0)
-        for (int i = 0; i < graph->special_branches.size; ++i) {
-            struct ggit_special_branch* i_branch = ggit_vector_ref_special_branch(
-                &graph->special_branches,
-                i
-            );
-            if (!stop) {
-                if (i == branch)
-                    stop = true;
-                else
-                    column += i_branch->instances.size;
-            } else if (i_branch->growth_direction < 0)
-                column += i_branch->instances.size;
-        }
-    else
-        for (int i = 0; i < graph->special_branches.size; ++i) {
-            if (i == branch)
-                break;
-
-            struct ggit_special_branch* i_branch = ggit_vector_ref_special_branch(
-                &graph->special_branches,
-                i
-            );
-            if (i_branch->growth_direction < 0)
-                column += i_branch->instances.size;
-        }
-    if (commit_branch->growth_direction >= 0) {
-        static struct ggit_vector spans;
-        if (!spans.value_size) {
-            ggit_vector_init(&spans, sizeof(struct ggit_column_span));
-            ggit_vector_reserve(&spans, 128);
-        } else {
-            ggit_vector_clear(&spans);
-        }
-
-        // Copy all spans to the temporary spans vector.
-        ggit_vector_reserve(&spans, commit_branch->spans.size);
-        memcpy(
-            spans.data,
-            commit_branch->spans.data,
-            commit_branch->spans.size * commit_branch->spans.value_size
-        );
-
-        /*
-        TODO:
-            Compute all column compressions - their spans in the temporary vector .
-        */
-        bool found = false;
-        for (int i = 0; i < index; ++i) {
-            struct ggit_column_span* i_span = ggit_vector_ref_column_span(&spans, i);
-            for (int j = i + 1; j < index; ++j) {
-                struct ggit_column_span* j_span = ggit_vector_ref_column_span(
-                    &spans,
-                    j
-                );
-                if (!spans_collide(i_span, j_span)) {
-                    spans_join(i_span, j_span);
-                    j_span->commit_max = -1;
-                    j_span->commit_min = -1;
-                    j_span->merge_max = -1;
-                    j_span->merge_min = -1;
-                }
-            }
-
-            if (!spans_collide(i_span, commit_branch_span)) {
-                index = i;
-                break;
-            }
-        }
-    }
-    column += index;
+    /* The spans were packed into the branch's columns once, when they were computed. */
+    int column = branch_column[tag.tag[0]]
+                 + ggit_span_index_slot(&commit_branch->span_index, tag.tag[1]);
 
-    if (compressed_x && compressed_x->size > column) {
-        column = ggit_vector_ref_compressed_x(compressed_x, column)->new_x;
+    if (compressed_x && (int)compressed_x->size > column) {
+        column = compressed_x->data[column].new_x;
     }
 
     return column;
 }
+static inline struct ggit_row const*
+ggit_ui_row(struct ggit_ui* ui, int row)
+{
+    return ui->cache.rows.data + row;
+}
+/* Compressed column the row is drawn in. Same as ggit_graph_commit_column, without the tag lookups. */
+static inline int
+ggit_ui_row_column(struct ggit_vec_compressed_x* compressed_x, struct ggit_row const* row)
+{
+    if (compressed_x->size > row->column)
+        return compressed_x->data[row->column].new_x;
+    return row->column;
+}
+/* Compressed column of any commit, from the cached raw columns. */
+static inline int
+ggit_ui_commit_column(struct ggit_ui* ui, struct ggit_vec_compressed_x* compressed_x, int commit)
+{
+    int const column = ui->cache.columns.data[commit];
+    if ((int)compressed_x->size > column)
+        return compressed_x->data[column].new_x;
+    return column;
+}
+/* Where a compressed column currently is, relative to where it will settle. */
+static int
+ggit_ui_column_offset(struct ggit_ui* ui, int column)
+{
+    struct ggit_vec_int const* offsets = &ui->cache.column_offset;
+    if (column < 0 || column >= (int)offsets->size)
+        return 0;
+    return offsets->data[column];
+}
 static int
 ggit_graph_commit_x_left(struct ggit_ui* ui, int column)
 {
     int const item_w = ui->item_w;
     int const item_outer_w = item_w + ui->border * 2;
     int const item_box_w = item_outer_w + ui->margin_x * 2;
-    return column * item_box_w;
+    return column * item_box_w + ggit_ui_column_offset(ui, column);
 }
 static int
 ggit_graph_commit_x_center(struct ggit_ui* ui, int column)
@@ -323,28 +307,159 @@ ggit_graph_commit_x_center(struct ggit_ui* ui, int column)
     int const item_w = ui->item_w;
     int const item_outer_w = item_w + ui->border * 2;
     int const item_box_w = item_outer_w + ui->margin_x * 2;
-    int const commit_x_center = (item_box_w / 2) + column * item_box_w;
+    int const commit_x_center = (item_box_w / 2) + column * item_box_w
+                                + ggit_ui_column_offset(ui, column);
     return commit_x_center;
 }
 static int
-ggit_graph_commit_y_top(struct ggit_ui* ui, int commit_index, int graph_height)
+ggit_graph_row_y_top(struct ggit_ui* ui, int row)
 {
     int const item_h = ui->item_h;
     int const item_outer_h = item_h + ui->border * 2;
     int const item_box_h = item_outer_h + ui->margin_y * 2;
-    int const commit_y_top = item_box_h * (graph_height - 1 - commit_index);
+    return (int)(((long long)item_box_h * row) >> ui->row_shift);
+}
+static int
+ggit_graph_commit_y_top(struct ggit_ui* ui, int commit_index)
+{
+    int const commit_y_top = ggit_graph_row_y_top(ui, ggit_view_row(&ui->view, commit_index));
     return commit_y_top;
 }
 static int
-ggit_graph_commit_y_center(struct ggit_ui* ui, int commit_index, int graph_height)
+ggit_graph_commit_y_center(struct ggit_ui* ui, int commit_index)
 {
     int const item_h = ui->item_h;
     int const item_outer_h = item_h + ui->border * 2;
     int const item_box_h = item_outer_h + ui->margin_y * 2;
-    int const commit_y_top = ggit_graph_commit_y_top(ui, commit_index, graph_height);
+    int const commit_y_top = ggit_graph_commit_y_top(ui, commit_index);
     int const commit_y_center = (item_box_h / 2) + commit_y_top;
     return commit_y_center;
 }
+static long long
+floor_div(long long a, long long b)
+{
+    long long q = a / b;
+    return q - ((a % b != 0) && ((a < 0) != (b < 0)));
+}
+/* Pixels (relative to graph_y) to rows, honoring the sub-pixel zoom. */
+static long long
+ggit_graph_pixels_to_rows(struct ggit_ui* ui, int pixels)
+{
+    return (long long)pixels * (1LL << ui->row_shift);
+}
+static bool
+ggit_ui_is_zoomed_out(struct ggit_ui* ui)
+{
+    int const item_box_h = ui->item_h + ui->border * 2 + ui->margin_y * 2;
+    return ui->row_shift > 0 || item_box_h < GGIT_LOD_ROW_PX;
+}
+/** Rows [*out_from, *out_to) have at least one pixel on screen. */
+static void
+ggit_ui_visible_rows(struct ggit_ui* ui, int graph_height, int* out_from, int* out_to)
+{
+    int const item_box_h = ui->item_h + ui->border * 2 + ui->margin_y * 2;
+
+    long long const top = ggit_graph_pixels_to_rows(ui, -ui->graph_y);
+    long long const bottom = ggit_graph_pixels_to_rows(ui, ui->screen_h - ui->graph_y);
+
+    long long const from = floor_div(top, item_box_h) - 1;
+    long long const to = -floor_div(-bottom, item_box_h) + 1;
+
+    *out_from = (int)max(0, min(from, graph_height));
+    *out_to = (int)max(0, min(to, graph_height));
+}
+/** The commit whose box contains the screen point (x, y), or -1.
+ *
+ * The row comes straight from y, so only the commit on that row has to be checked.
+ */
+static int
+ggit_graph_commit_at(
+    struct ggit_ui* ui,
+    struct ggit_graph* graph,
+    struct ggit_vec_compressed_x* compressed_x,
+    int x,
+    int y
+)
+{
+    int const item_box_h = ui->item_h + ui->border * 2 + ui->margin_y * 2;
+    int const rows = ui->view.height;
+
+    long long const row = floor_div(
+        ggit_graph_pixels_to_rows(ui, y - ui->graph_y),
+        item_box_h
+    );
+    if (row < 0 || row >= rows)
+        return -1;
+
+    int const commit_i = ggit_view_commit(&ui->view, row);
+    int const column = ggit_ui_commit_column(ui, compressed_x, commit_i);
+
+    int const commit_x_left = ui->graph_x + ui->margin_x + ui->border
+                              + ggit_graph_commit_x_left(ui, column);
+    int const commit_y_top = ui->graph_y + ui->margin_y + ui->border
+                             + ggit_graph_commit_y_top(ui, commit_i);
+    if (!point_in_rect(
+            commit_x_left,
+            commit_y_top,
+            commit_x_left + ui->item_w,
+            commit_y_top + ui->item_h,
+            x,
+            y
+        ))
+        return -1;
+    return commit_i;
+}
+/** Selects every commit whose center lies inside the rectangle.
+ *
+ * The rectangle is turned into a row range, so the cost is proportional to the
+ * rows it covers, not the size of the history. Columns are compared where they
+ * are drawn, mid-animation included. Returns the selected commit closest to
+ * where the rectangle ended (x1, y1), -1 when nothing was inside.
+ */
+static int
+ggit_graph_commits_in_rect(
+    struct ggit_ui* ui,
+    struct ggit_graph* graph,
+    struct ggit_vec_compressed_x* compressed_x,
+    int x0,
+    int y0,
+    int x1,
+    int y1,
+    struct ggit_bitset* out_commits
+)
+{
+    int const item_box_h = ui->item_h + ui->border * 2 + ui->margin_y * 2;
+    int const rows = ui->view.height;
+
+    int const left = min(x0, x1) - ui->graph_x;
+    int const right = max(x0, x1) - ui->graph_x;
+    int const top = min(y0, y1) - ui->graph_y - item_box_h / 2;
+    int const bottom = max(y0, y1) - ui->graph_y - item_box_h / 2;
+
+    int const row_min = (int)max(
+        0,
+        -floor_div(-ggit_graph_pixels_to_rows(ui, top), item_box_h)
+    );
+    int const row_max = (int)min(
+        rows - 1,
+        floor_div(ggit_graph_pixels_to_rows(ui, bottom), item_box_h)
+    );
+
+    /* Rows are walked bottom up, so a rectangle dragged downwards ends at the first hit. */
+    bool const ends_below = y1 >= y0;
+    int end_commit = -1;
+    for (int row = row_max; row >= row_min; --row) {
+        int const commit_i = ggit_view_commit(&ui->view, row);
+        int const column = ggit_ui_commit_column(ui, compressed_x, commit_i);
+        int const x_center = ggit_graph_commit_x_center(ui, column);
+        if (x_center < left || x_center > right)
+            continue;
+        ggit_bitset_set(out_commits, commit_i);
+        if (!ends_below || end_commit == -1)
+            end_commit = commit_i;
+    }
+    return end_commit;
+}
 
 static void
 ggit_ui_draw_graph__connections(
@@ -352,7 +467,7 @@ ggit_ui_draw_graph__connections(
     struct ggit_graph* graph,
     int i_from,
     int i_to,
-    struct ggit_vector* compressed_x
+    struct ggit_vec_compressed_x* compressed_x
 )
 {
     SDL_Renderer* const renderer = ui->renderer;
@@ -360,72 +475,46 @@ ggit_ui_draw_graph__connections(
 
     int const graph_x = ui->graph_x;
     int const graph_y = ui->graph_y;
-    int const G_HEIGHT = graph->height;
-    int const G_WIDTH = graph->width;
 
     int const ITEM_H = ui->item_h;
-    int const ITEM_W = ui->item_w;
     int const BORDER = ui->border;
-    int const MARGIN_X = ui->margin_x;
     int const MARGIN_Y = ui->margin_y;
 
-    int const ITEM_OUTER_H = ITEM_W + BORDER * 2;
-    int const ITEM_OUTER_W = ITEM_H + BORDER * 2;
-    int const ITEM_BOX_H = ITEM_OUTER_W + MARGIN_X * 2;
-    int const ITEM_BOX_W = ITEM_OUTER_H + MARGIN_Y * 2;
-
     SDL_SetRenderDrawColor(renderer, 0xAA, 0xAA, 0xAA, 0xFF);
     for (int i = i_from; i < i_to; ++i) {
-        int const commit_i = G_HEIGHT - 1 - i;
-        int const column = ggit_graph_commit_column(graph, compressed_x, commit_i);
+        struct ggit_row const* row = ggit_ui_row(ui, i);
+        int const commit_i = row->commit;
+        int const column = ggit_ui_row_column(compressed_x, row);
 
         int const commit_x_source = ggit_graph_commit_x_left(ui, column);
-        int const commit_y_source = ggit_graph_commit_y_center(ui, commit_i, G_HEIGHT);
+        int const commit_y_source = ggit_graph_commit_y_center(ui, commit_i);
         int const commit_x_center_source = ggit_graph_commit_x_center(ui, column);
-        int const commit_y_center_source = ggit_graph_commit_y_center(
-            ui,
-            commit_i,
-            G_HEIGHT
-        );
+        int const commit_y_center_source = ggit_graph_commit_y_center(ui, commit_i);
 
         int const commit_x = graph_x + commit_x_source;
         int const commit_y = graph_y + commit_y_source;
         int const commit_x_center = graph_x + commit_x_center_source;
-        int const commit_y_center = graph_y
-                                    + ggit_graph_commit_y_center(
-                                        ui,
-                                        commit_i,
-                                        G_HEIGHT
-                                    );
+        int const commit_y_center = graph_y + commit_y_center_source;
         int const commit_y_bottom = commit_y + ITEM_H / 2 + BORDER + MARGIN_Y;
 
-        bool is_merge = graph->parents[commit_i].parent[1] != -1;
-        for (int j = 0; j < ARRAY_COUNT(graph->parents->parent); ++j) {
-            int parent = graph->parents[commit_i].parent[j];
-            if (parent == -1)
-                break;
-            int const parent_column = ggit_graph_commit_column(
-                graph,
-                compressed_x,
-                parent
-            );
+        /* Parents as the view sees them - hidden ones skipped. */
+        int n_parents;
+        int const* parents = ggit_parents_of(ui->view.parents, commit_i, &n_parents);
+        bool is_merge = n_parents > 1;
+        for (int j = 0; j < n_parents; ++j) {
+            int parent = parents[j];
+            int const parent_column = ggit_ui_commit_column(ui, compressed_x, parent);
             int const parent_x_center = graph_x
                                         + ggit_graph_commit_x_center(ui, parent_column);
-            int const parent_y_top = graph_y
-                                     + ggit_graph_commit_y_top(ui, parent, G_HEIGHT);
-            int const parent_y_center_source = ggit_graph_commit_y_center(
-                ui,
-                parent,
-                G_HEIGHT
-            );
+            int const parent_y_top = graph_y + ggit_graph_commit_y_top(ui, parent);
+            int const parent_y_center_source = ggit_graph_commit_y_center(ui, parent);
             int const parent_y_center = graph_y + parent_y_center_source;
 
             if (parent_x_center != commit_x_center) {
                 int arc_radius = 5;
                 int direction = 1 + (-2) * (parent_x_center > commit_x_center);
                 if (j) {
-                    // This is the "secondary" parent - the merged-in branch.
-                    assert(j == 1);
+                    // A "secondary" parent - a merged-in branch (or one arm of an octopus).
                     SDL_SetRenderDrawColor(ui->renderer, 0xAA, 0xAA, 0xAA, 0xFF);
                     ggit_ui_draw_arc(
                         ui->renderer,
@@ -437,7 +526,7 @@ ggit_ui_draw_graph__connections(
                     );
 
                     // Middle - left/right to match parent column
-                    SDL_RenderDrawLine(
+                    ggit_ui_draw_line(
                         renderer,
                         commit_x_center,
                         commit_y_center,
@@ -446,7 +535,7 @@ ggit_ui_draw_graph__connections(
                     );
 
                     // Middle - down to match parent top
-                    SDL_RenderDrawLine(
+                    ggit_ui_draw_line(
                         renderer,
                         parent_x_center,
                         commit_y + arc_radius,
@@ -474,7 +563,7 @@ ggit_ui_draw_graph__connections(
                     );
 
                     // Middle - left/right to match parent column
-                    SDL_RenderDrawLine(
+                    ggit_ui_draw_line(
                         renderer,
                         commit_x_center - arc_radius * direction,
                         parent_y_top,
@@ -482,7 +571,7 @@ ggit_ui_draw_graph__connections(
                         parent_y_top
                     );
                     // Middle - down to match parent top
-                    SDL_RenderDrawLine(
+                    ggit_ui_draw_line(
                         renderer,
                         commit_x_center,
                         commit_y,
@@ -493,7 +582,7 @@ ggit_ui_draw_graph__connections(
             } else {
                 // Commit - center to bottom
                 int const offset_merge = is_merge * -2;
-                SDL_RenderDrawLine(
+                ggit_ui_draw_line(
                     renderer,
                     commit_x_center,
                     commit_y_bottom + offset_merge,
@@ -501,7 +590,7 @@ ggit_ui_draw_graph__connections(
                     commit_y
                 );
                 // Middle - down to match parent top
-                SDL_RenderDrawLine(
+                ggit_ui_draw_line(
                     renderer,
                     commit_x_center,
                     commit_y_bottom + offset_merge,
@@ -509,7 +598,7 @@ ggit_ui_draw_graph__connections(
                     parent_y_top
                 );
                 // Parent - center to top.
-                SDL_RenderDrawLine(
+                ggit_ui_draw_line(
                     renderer,
                     parent_x_center,
                     parent_y_top,
@@ -521,6 +610,66 @@ ggit_ui_draw_graph__connections(
     }
 }
 
+/** The branch instance drawn under the mouse, -1 if none. O(log columns + log branches + log instances). */
+static int
+ggit_ui_hovered_instance(
+    struct ggit_ui* ui,
+    struct ggit_graph* graph,
+    struct ggit_input* input,
+    struct ggit_vec_compressed_x* compressed_x
+)
+{
+    struct ggit_view const* view = &ui->view;
+    int const item_outer_w = ui->item_w + ui->border * 2;
+    int const item_box_w = item_outer_w + ui->margin_x * 2;
+    int const item_box_h = ui->item_h + ui->border * 2 + ui->margin_y * 2;
+
+    int const x = input->mouse_x - ui->graph_x;
+    int const y = input->mouse_y - ui->graph_y;
+    if (x < 0 || y < 0 || x % item_box_w < ui->margin_x
+        || x % item_box_w >= ui->margin_x + item_outer_w)
+        return -1;
+
+    long long const row = ggit_graph_pixels_to_rows(ui, y) / item_box_h;
+    if (row >= view->height)
+        return -1;
+    int const commit = ggit_view_commit(view, (int)row);
+
+    /* NOTE(boz):
+        new_x counts the taken columns before each raw one, so it never goes
+        down - the raw column drawn at `target` is the first taken one with it.
+    */
+    int const target = x / item_box_w;
+    int lo = 0;
+    int hi = (int)compressed_x->size;
+    while (lo < hi) {
+        int const mid = (lo + hi) / 2;
+        struct compressed_x const* cx = compressed_x->data + mid;
+        if (cx->new_x < target || (cx->new_x == target && !cx->taken))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (lo == (int)compressed_x->size)
+        return -1;
+    struct compressed_x const* cx = compressed_x->data + lo;
+    if (!cx->taken || cx->new_x != target)
+        return -1;
+    int const column = lo;
+
+    // The branch owning the column, then its span index knows the instance.
+    int const b = ggit_ui_column_branch(ui, graph, column);
+    if (b == -1)
+        return -1;
+    struct ggit_special_branch* sb = ggit_vector_ref_special_branch(
+        &graph->special_branches,
+        b
+    );
+    int const slot = column - ui->cache.branch_column.data[b];
+    int const j = ggit_span_index_find(&sb->span_index, slot, commit);
+    return j == -1 ? -1 : graph->instance_base[b] + j;
+}
+/** Highlights the branch instance under the mouse - its span and its commits on screen. */
 static void
 ggit_ui_draw_graph__spans(
     struct ggit_ui* ui,
@@ -528,14 +677,12 @@ ggit_ui_draw_graph__spans(
     struct ggit_input* input,
     int i_from,
     int i_to,
-    struct ggit_vector* compressed_x
+    struct ggit_vec_compressed_x* compressed_x
 )
 {
     SDL_Renderer* const renderer = ui->renderer;
     int const graph_x = ui->graph_x;
     int const graph_y = ui->graph_y;
-    int const G_WIDTH = graph->width;
-    int const G_HEIGHT = graph->height;
 
     int const ITEM_W = ui->item_w;
     int const ITEM_H = ui->item_h;
@@ -545,83 +692,75 @@ ggit_ui_draw_graph__spans(
 
     int const ITEM_OUTER_W = ITEM_W + BORDER * 2;
     int const ITEM_OUTER_H = ITEM_H + BORDER * 2;
-    int const ITEM_BOX_W = ITEM_OUTER_W + MARGIN_X * 2;
-    int const ITEM_BOX_H = ITEM_OUTER_H + MARGIN_Y * 2;
 
-    int n_hovered = 0;
-    // puts("\nHovered:");
+    if (i_from >= i_to)
+        return;
+    int const instance = ggit_ui_hovered_instance(ui, graph, input, compressed_x);
+    if (instance == -1)
+        return;
 
-    for (int i = i_from; i < i_to; ++i) {
-        int const commit_i = G_HEIGHT - 1 - i;
-        struct ggit_commit_tag const tags = graph->tags[commit_i];
-        int const i_branch = tags.tag[0];
-        int const index = tags.tag[1];
-        if (i_branch == -1)
-            continue;
-        struct ggit_special_branch* branch = ggit_vector_ref_special_branch(
-            &graph->special_branches,
-            i_branch
-        );
-        SDL_Color color = {
-            .r = branch->colors_base[0][0],
-            .g = branch->colors_base[0][1],
-            .b = branch->colors_base[0][2],
-        };
-        struct ggit_special_branch* commit_branch = ggit_vector_ref_special_branch(
-            &graph->special_branches,
-            i_branch
-        );
-        struct ggit_column_span* commit_branch_span = ggit_vector_ref_column_span(
-            &commit_branch->spans,
-            index
-        );
+    int n_members;
+    int const* members = ggit_graph_instance_members(graph, instance, &n_members);
 
-        int const column = ggit_graph_commit_column(graph, compressed_x, commit_i);
-        /* Use the base color but increase the brightness. */
-        color.r = min(255, color.r + 90);
-        color.g = min(255, color.g + 90);
-        color.b = min(255, color.b + 90);
-
-        int const commit_x0 = MARGIN_X + graph_x + ggit_graph_commit_x_left(ui, column);
-        int span_y_top = BORDER + MARGIN_Y + graph_y
-                         + ggit_graph_commit_y_top(
-                             ui,
-                             commit_branch_span->merge_max,
-                             G_HEIGHT
-                         );
-        int span_y_bottom = ITEM_OUTER_H + graph_y
-                            + ggit_graph_commit_y_top(
-                                ui,
-                                commit_branch_span->merge_min,
-                                G_HEIGHT
-                            );
-
-
-        int const commit_x1 = commit_x0 + ITEM_OUTER_W;
-
-        if (point_in_rect(
-                commit_x0,
-                span_y_top,
-                commit_x1,
-                span_y_bottom,
-                input->mouse_x,
-                input->mouse_y
-            )) {
-            ++n_hovered;
-            ggit_ui_draw_rect_cut(
-                renderer,
-                commit_x0,
-                span_y_top,
-                commit_x1,
-                span_y_bottom,
-                ITEM_OUTER_W / 2,
-                color
-            );
-        }
+    struct ggit_commit_tag const tags = graph->tags[members[0]];
+    struct ggit_special_branch* branch = ggit_vector_ref_special_branch(
+        &graph->special_branches,
+        tags.tag[0]
+    );
+    struct ggit_column_span* span = ggit_vector_ref_column_span(&branch->spans, tags.tag[1]);
+
+    /* Use the base color but increase the brightness. */
+    SDL_Color color = {
+        .r = min(255, branch->colors_base[0][0] + 90),
+        .g = min(255, branch->colors_base[0][1] + 90),
+        .b = min(255, branch->colors_base[0][2] + 90),
+    };
+
+    int const column = ggit_ui_commit_column(ui, compressed_x, members[0]);
+    int const commit_x0 = MARGIN_X + graph_x + ggit_graph_commit_x_left(ui, column);
+    int const commit_x1 = commit_x0 + ITEM_OUTER_W;
+    int const span_y_top = BORDER + MARGIN_Y + graph_y
+                           + ggit_graph_commit_y_top(ui, span->merge_max);
+    int const span_y_bottom = ITEM_OUTER_H + graph_y
+                              + ggit_graph_commit_y_top(ui, span->merge_min);
+    ggit_ui_draw_rect_cut(
+        renderer,
+        commit_x0,
+        span_y_top,
+        commit_x1,
+        span_y_bottom,
+        ITEM_OUTER_W / 2,
+        color
+    );
+
+    /* NOTE(boz):
+        Rows on screen hold commits [oldest, newest], members are sorted, so
+        only the ones in that range are looked at.
+    */
+    int const newest = ggit_view_commit(&ui->view, i_from);
+    int const oldest = ggit_view_commit(&ui->view, i_to - 1);
+    int lo = 0;
+    int hi = n_members;
+    while (lo < hi) {
+        int const mid = (lo + hi) / 2;
+        if (members[mid] < oldest)
+            lo = mid + 1;
+        else
+            hi = mid;
     }
-    if (n_hovered) {
-        /* TODO: uncomment this */
-        // assert(n_hovered <= 1);
+
+    SDL_SetRenderDrawColor(renderer, color.r / 2, color.g / 2, color.b / 2, 0xFF);
+    for (int i = lo; i < n_members && members[i] <= newest; ++i) {
+        int const commit_i = members[i];
+        if (!ggit_view_is_visible(&ui->view, commit_i))
+            continue;
+        SDL_Rect const halo = {
+            commit_x0 - MARGIN_X / 2,
+            graph_y + ggit_graph_commit_y_top(ui, commit_i) + MARGIN_Y / 2,
+            ITEM_OUTER_W + MARGIN_X,
+            ITEM_OUTER_H + MARGIN_Y,
+        };
+        SDL_RenderFillRect(renderer, &halo);
     }
 }
 
@@ -632,7 +771,7 @@ ggit_ui_draw_graph__commit_messages(
     int i_from,
     int i_to,
     int compressed_width,
-    struct ggit_vector* compressed_x
+    struct ggit_vec_compressed_x* compressed_x
 )
 {
     SDL_Renderer* const renderer = ui->renderer;
@@ -641,34 +780,135 @@ ggit_ui_draw_graph__commit_messages(
     int const graph_x = ui->graph_x;
     int const graph_y = ui->graph_y;
 
-    int const G_WIDTH = graph->width;
-    int const G_HEIGHT = graph->height;
-
-    int const SCREEN_W = ui->screen_w;
     int const SCREEN_H = ui->screen_h;
     int const ITEM_W = ui->item_w;
     int const ITEM_H = ui->item_h;
     int const BORDER = ui->border;
     int const MARGIN_X = ui->margin_x;
-    int const MARGIN_Y = ui->margin_y;
 
     int const ITEM_OUTER_W = ITEM_W + BORDER * 2;
-    int const ITEM_OUTER_H = ITEM_H + BORDER * 2;
     int const ITEM_BOX_W = ITEM_OUTER_W + MARGIN_X * 2;
-    int const ITEM_BOX_H = ITEM_OUTER_H + MARGIN_Y * 2;
 
 
     int const text_x = graph_x + compressed_width * ITEM_BOX_W + ITEM_BOX_W / 2;
     for (int i = i_from; i < i_to; ++i) {
-        int const commit_i = G_HEIGHT - 1 - i;
-        int const commit_y = graph_y + ggit_graph_commit_y_top(ui, commit_i, G_HEIGHT);
+        int const commit_y = graph_y + ggit_graph_row_y_top(ui, i);
         if (commit_y < -ITEM_H || commit_y > SCREEN_H)
             continue;
 
-        char const* message = graph->messages[commit_i];
+        struct ggit_row const* row = ggit_ui_row(ui, i);
+        char const* message = graph->message_store + row->message_offset;
+        char fold[64];
+        if (row->flags & ggit_row_fold) {
+            snprintf(fold, sizeof(fold), "... %d commits ...", ggit_view_fold(&ui->view, row->commit));
+            message = fold;
+        }
         ggit_ui_draw_text(renderer, font, message, text_x, commit_y, 0);
     }
 }
+/* Forgets the highlighted history when the graph it was computed on is gone. */
+static void
+ggit_ui_ancestry__sync(struct ggit_ui* ui, struct ggit_graph* graph)
+{
+    if (ui->ancestry.graph_revision == graph->revision)
+        return;
+    ui->ancestry.graph_revision = graph->revision;
+    ui->ancestry.root = -1;
+    ui->ancestry.contains_commit = -1;
+}
+/** Does the ref point at a descendant of `commit` (or at it)? Memoized per picked commit. */
+static bool
+ggit_ui_ancestry_ref_contains(struct ggit_ui* ui, struct ggit_graph* graph, int ref, int commit)
+{
+    if (commit == -1)
+        return false;
+
+    struct ggit_vector* contains = &ui->ancestry.contains;
+    if (ui->ancestry.contains_commit != commit || contains->size != graph->ref_commits.size) {
+        ui->ancestry.contains_commit = commit;
+        ggit_vector_clear(contains);
+        ggit_vector_reserve(contains, graph->ref_commits.size);
+        contains->size = graph->ref_commits.size;
+        memset(contains->data, -1, contains->size);
+    }
+
+    int8_t* known = (int8_t*)contains->data + ref;
+    if (*known == -1) {
+        int const ref_commit = ggit_vector_get_int(&graph->ref_commits, ref);
+        *known = ref_commit != -1
+                 && ggit_ancestry_is_ancestor(&ui->ancestry.engine, graph, commit, ref_commit);
+    }
+    return *known;
+}
+/* Throws away the label cache once the refs it was made for are gone. */
+static void
+ggit_ui_labels__sync(struct ggit_ui* ui, struct ggit_graph* graph)
+{
+    struct ggit_vec_size* sizes = &ui->labels.sizes;
+    struct ggit_vec_texture* textures = &ui->labels.textures;
+    int const n_refs = graph->ref_names.size;
+    if (ui->labels.graph_revision == graph->revision && sizes->size == (size_t)n_refs)
+        return;
+    ui->labels.graph_revision = graph->revision;
+
+    for (size_t i = 0; i < textures->size; ++i) {
+        if (textures->data[i])
+            SDL_DestroyTexture(textures->data[i]);
+    }
+    ggit_vec_size_clear(sizes);
+    memset(ggit_vec_size_extend(sizes, (size_t)n_refs), 0xFF, n_refs * sizeof(struct ggit_size));
+    ggit_vec_texture_clear(textures);
+    memset(ggit_vec_texture_extend(textures, (size_t)n_refs), 0, n_refs * sizeof(SDL_Texture*));
+    ui->labels.n_textures = 0;
+    ui->labels.texture_bytes = 0;
+}
+/** Size of the ref's label. Measured the first time it is asked for. */
+static struct ggit_size
+ggit_ui_label_size(struct ggit_ui* ui, struct ggit_graph* graph, int ref)
+{
+    struct ggit_size* size = ui->labels.sizes.data + ref;
+    if (size->w == -1) {
+        char const* name = ggit_vector_get_string(&graph->ref_names, ref);
+        *size = ggit_ui_size_text(ui->renderer, ui->font, name);
+    }
+    return *size;
+}
+/** The ref's label as a texture, rendered on first use. */
+static SDL_Texture*
+ggit_ui_label_texture(struct ggit_ui* ui, struct ggit_graph* graph, int ref)
+{
+    struct ggit_vec_texture* textures = &ui->labels.textures;
+    SDL_Texture** texture = textures->data + ref;
+    if (*texture)
+        return *texture;
+
+    /* NOTE(boz):
+        Scrolling through 40k tags would otherwise keep 40k textures alive.
+        Starting over is cheap - only what's on screen gets rendered again.
+    */
+    if (ui->labels.n_textures >= GGIT_LABEL_TEXTURES) {
+        for (size_t i = 0; i < textures->size; ++i) {
+            if (textures->data[i]) {
+                SDL_DestroyTexture(textures->data[i]);
+                textures->data[i] = 0;
+            }
+        }
+        ui->labels.n_textures = 0;
+        ui->labels.texture_bytes = 0;
+    }
+
+    /* Only written when the text renders - a failed one keeps the measured size. */
+    struct ggit_size size = ggit_ui_label_size(ui, graph, ref);
+    char const* name = ggit_vector_get_string(&graph->ref_names, ref);
+    *texture = ggit_ui_create_text_texture(ui->renderer, ui->font, name, &size);
+    if (!*texture)
+        return 0;
+    ui->labels.n_textures += 1;
+    ui->labels.texture_bytes += (size_t)size.w * size.h * 4;
+    ui->labels.sizes.data[ref] = size;
+    return *texture;
+}
+/** Ref labels left of the graph and lines to their commits. Only rows on screen are visited. */
 static void
 ggit_ui_draw_graph__refs(
     struct ggit_ui* ui,
@@ -677,67 +917,93 @@ ggit_ui_draw_graph__refs(
     int i_from,
     int i_to,
     int compressed_width,
-    struct ggit_vector* compressed_x
+    struct ggit_vec_compressed_x* compressed_x
 )
 {
     SDL_Renderer* const renderer = ui->renderer;
-    TTF_Font* const font = ui->font;
 
     int const graph_x = ui->graph_x;
     int const graph_y = ui->graph_y;
-    int const G_WIDTH = graph->width;
-    int const G_HEIGHT = graph->height;
 
-    int const SCREEN_W = ui->screen_w;
     int const SCREEN_H = ui->screen_h;
-    int const ITEM_W = ui->item_w;
     int const ITEM_H = ui->item_h;
     int const BORDER = ui->border;
-    int const MARGIN_X = ui->margin_x;
     int const MARGIN_Y = ui->margin_y;
 
-    int const ITEM_OUTER_W = ITEM_W + BORDER * 2;
     int const ITEM_OUTER_H = ITEM_H + BORDER * 2;
-    int const ITEM_BOX_W = ITEM_OUTER_W + MARGIN_X * 2;
     int const ITEM_BOX_H = ITEM_OUTER_H + MARGIN_Y * 2;
 
-    int const n_refs = graph->ref_names.size;
+    int const active = ui->select.active_commit;
+    unsigned const lmb = input->buttons[0];
+    bool const clicked = lmb && !(lmb & 1);
 
-    for (int i = 0; i < n_refs; ++i) {
-        int const commit_i = ggit_vector_get_int(&graph->ref_commits, i);
+    ggit_ui_labels__sync(ui, graph);
 
-        int ci = G_HEIGHT - 1 - commit_i;
-        if (ci < i_from || ci >= i_to)
+    for (int row = i_from; row < i_to; ++row) {
+        struct ggit_row const* hot = ggit_ui_row(ui, row);
+        if (!(hot->flags & ggit_row_ref))
             continue;
+        int const commit_i = hot->commit;
 
-        char const* name = ggit_vector_get_string(&graph->ref_names, i);
-
-        int const commit_y = graph_y + ggit_graph_commit_y_top(ui, commit_i, G_HEIGHT);
-        int const commit_y_center = commit_y + ITEM_BOX_H / 2;
+        int n_refs;
+        int const* refs = ggit_graph_commit_refs(graph, commit_i, &n_refs);
+        if (!n_refs)
+            continue;
 
+        int const commit_y = graph_y + ggit_graph_commit_y_top(ui, commit_i);
         if (commit_y < -ITEM_H || commit_y > SCREEN_H)
             continue;
 
-        ggit_ui_draw_text(renderer, font, name, 0, commit_y, 0);
-    }
+        /* Refs of the same commit go side by side. */
+        int label_x = 6;
+        for (int j = 0; j < n_refs; ++j) {
+            int const ref = refs[j];
 
-    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0xFF);
-    for (int i = 0; i < n_refs; ++i) {
-        int const commit_i = ggit_vector_get_int(&graph->ref_commits, i);
+            /* Refs that contain the picked commit get a mark in front of them. */
+            if (ggit_ui_ancestry_ref_contains(ui, graph, ref, active)) {
+                SDL_SetRenderDrawColor(renderer, 0x7E, 0xD3, 0x21, 0xFF);
+                SDL_RenderFillRect(
+                    renderer,
+                    &(SDL_Rect){ label_x - 6, commit_y, 4, ITEM_BOX_H }
+                );
+            }
 
-        int ci = G_HEIGHT - 1 - commit_i;
-        if (ci < i_from || ci >= i_to)
-            continue;
+            SDL_Texture* texture = ggit_ui_label_texture(ui, graph, ref);
+            struct ggit_size const size = ggit_ui_label_size(ui, graph, ref);
+            ggit_profile_count_draw(4);
+            SDL_RenderCopy(
+                renderer,
+                texture,
+                NULL,
+                &(SDL_Rect){ label_x, commit_y, size.w, size.h }
+            );
 
-        int const column = ggit_graph_commit_column(graph, compressed_x, commit_i);
+            // Clicking a ref highlights everything it contains.
+            if (clicked
+                && point_in_rect(
+                    label_x,
+                    commit_y,
+                    label_x + size.w,
+                    commit_y + size.h,
+                    input->mouse_x,
+                    input->mouse_y
+                )) {
+                bool const same = ui->ancestry.root == commit_i && !ui->ancestry.descendants;
+                ui->ancestry.root = same ? -1 : commit_i;
+                ui->ancestry.descendants = false;
+                ui->dirty = true;
+            }
+            label_x += size.w + 12;
+        }
 
-        int const commit_y = graph_y + ggit_graph_commit_y_top(ui, commit_i, G_HEIGHT);
+        int const column = ggit_ui_commit_column(ui, compressed_x, commit_i);
 
         /* With an offset so we don't clash with actual graph lines. */
         int const commit_y_center = commit_y + ITEM_BOX_H / 2 - 3;
 
         int const commit_x = graph_x + ggit_graph_commit_x_center(ui, column);
-        SDL_RenderDrawLine(renderer, 0, commit_y_center, commit_x, commit_y_center);
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0xFF);
+        ggit_ui_draw_line(renderer, 0, commit_y_center, commit_x, commit_y_center);
     }
 }
 static void
@@ -746,15 +1012,12 @@ ggit_ui_draw_graph__boxes(
     struct ggit_graph* graph,
     int i_from,
     int i_to,
-    struct ggit_vector* compressed_x
+    struct ggit_vec_compressed_x* compressed_x
 )
 {
     int const graph_x = ui->graph_x;
     int const graph_y = ui->graph_y;
-    int const G_WIDTH = graph->width;
-    int const G_HEIGHT = graph->height;
 
-    int const SCREEN_W = ui->screen_w;
     int const SCREEN_H = ui->screen_h;
     int const ITEM_W = ui->item_w;
     int const ITEM_H = ui->item_h;
@@ -762,21 +1025,24 @@ ggit_ui_draw_graph__boxes(
     int const MARGIN_X = ui->margin_x;
     int const MARGIN_Y = ui->margin_y;
 
-    int const ITEM_OUTER_W = ITEM_W + BORDER * 2;
-    int const ITEM_OUTER_H = ITEM_H + BORDER * 2;
-    int const ITEM_BOX_W = ITEM_OUTER_W + MARGIN_X * 2;
-    int const ITEM_BOX_H = ITEM_OUTER_H + MARGIN_Y * 2;
+    /* Everything outside of the clicked ref's history (or the descendants of the
+       highlighted commit) fades out. */
+    struct ggit_bitset const* history = 0;
+    if (ui->ancestry.root != -1 && ui->ancestry.descendants)
+        history = ggit_ancestry_descendants(&ui->ancestry.engine, graph, ui->ancestry.root);
+    else if (ui->ancestry.root != -1)
+        history = ggit_ancestry_reachable(&ui->ancestry.engine, graph, ui->ancestry.root);
 
     for (int i = i_from; i < i_to; ++i) {
-        int const commit_i = G_HEIGHT - 1 - i;
-        int const i_branch = graph->tags[commit_i].tag[0];
-        int const column = ggit_graph_commit_column(graph, compressed_x, commit_i);
+        struct ggit_row const* row = ggit_ui_row(ui, i);
+        int const commit_i = row->commit;
+        int const i_branch = row->branch;
+        int const column = ggit_ui_row_column(compressed_x, row);
         int const commit_x = MARGIN_X + graph_x + BORDER
                              + ggit_graph_commit_x_left(ui, column);
-        int const commit_y = MARGIN_Y + graph_y + BORDER
-                             + +ggit_graph_commit_y_top(ui, commit_i, G_HEIGHT);
+        int const commit_y = MARGIN_Y + graph_y + BORDER + ggit_graph_row_y_top(ui, i);
 
-        bool const is_merge = graph->parents[commit_i].parent[1] != -1;
+        bool const is_merge = row->flags & ggit_row_merge;
         int const cut = 2 + 2 * is_merge;
 
         if (commit_y < -ITEM_H || commit_y > SCREEN_H)
@@ -801,26 +1067,42 @@ ggit_ui_draw_graph__boxes(
                 0x15,
             };
         }
+        if (history && !ggit_bitset_test(history, commit_i)) {
+            color.r = (color.r + 3 * 245) / 4;
+            color.g = (color.g + 3 * 245) / 4;
+            color.b = (color.b + 3 * 245) / 4;
+        }
 
-        for (int j = 0; j < ui->select.selected_commits.size; ++j) {
-            int selected = ggit_vector_get_int(&ui->select.selected_commits, j);
-            if (selected == commit_i) {
-                SDL_Color color = {
-                    0x00,
-                    0x00,
-                    0x00,
-                };
-                ggit_ui_draw_rect_cut(
-                    ui->renderer,
-                    commit_x - BORDER,
-                    commit_y - BORDER,
-                    commit_x + ITEM_W + BORDER,
-                    commit_y + ITEM_H + BORDER,
-                    cut,
-                    color
-                );
-                break;
-            }
+        if (ggit_bitset_test(&ui->search.matches, commit_i)) {
+            bool const current = commit_i == ui->search.current;
+            int const grow = BORDER * (2 + current);
+            SDL_Color color = current ? (SDL_Color){ 0xFF, 0x80, 0x00 }
+                                      : (SDL_Color){ 0xFF, 0xD0, 0x00 };
+            ggit_ui_draw_rect_cut(
+                ui->renderer,
+                commit_x - grow,
+                commit_y - grow,
+                commit_x + ITEM_W + grow,
+                commit_y + ITEM_H + grow,
+                cut + grow / 2,
+                color
+            );
+        }
+        if (ggit_bitset_test(&ui->select.selected, commit_i)) {
+            SDL_Color color = {
+                0x00,
+                0x00,
+                0x00,
+            };
+            ggit_ui_draw_rect_cut(
+                ui->renderer,
+                commit_x - BORDER,
+                commit_y - BORDER,
+                commit_x + ITEM_W + BORDER,
+                commit_y + ITEM_H + BORDER,
+                cut,
+                color
+            );
         }
         ggit_ui_draw_rect_cut(
             ui->renderer,
@@ -833,95 +1115,389 @@ ggit_ui_draw_graph__boxes(
         );
     }
 }
+/** Numbers the taken columns left to right.
+ *
+ * Columns that are not taken get the number of the next taken one, so edges going
+ * to commits off screen still land somewhere sensible.
+ */
 static int
-ggit_ui_graph__generate_compressed_x(
-    struct ggit_graph* graph,
-    int i_from,
-    int i_to,
-    struct ggit_vector* compressed_x
-)
+ggit_ui_graph__assign_compressed_x(struct ggit_vec_compressed_x* compressed_x)
 {
-    int const g_width = graph->width;
-    int const g_height = graph->height;
-
-    if (compressed_x->data)
-        ggit_vector_destroy(compressed_x);
-
-    ggit_vector_init(compressed_x, sizeof(struct compressed_x));
-
-    ggit_vector_reserve(compressed_x, g_width);
-    memset(compressed_x->data, 0, compressed_x->capacity * compressed_x->value_size);
-    compressed_x->size = g_width;
-    for (int i = i_from; i < i_to; ++i) {
-        int const commit_i = g_height - 1 - i;
-        int x = ggit_graph_commit_column(graph, 0, commit_i);
-
-        ggit_vector_ref_compressed_x(compressed_x, x)->taken = true;
-    }
-
     int counter = 0;
-    for (int i = 0; i < g_width; ++i) {
-        struct compressed_x* cx = ggit_vector_ref_compressed_x(compressed_x, i);
+    for (size_t i = 0; i < compressed_x->size; ++i) {
+        struct compressed_x* cx = compressed_x->data + i;
+        cx->new_x = counter;
         if (cx->taken) {
-            cx->new_x = counter++;
+            counter++;
         }
     }
     return counter;
 }
-
+/** Raw column of every commit. Only depends on the graph, not on the filter. */
 static void
-ggit_ui_draw_graph(
-    struct ggit_ui* ui,
-    struct ggit_input* input,
-    struct ggit_graph* graph
-)
+ggit_ui_graph__generate_columns(struct ggit_ui* ui, struct ggit_graph* graph)
 {
-    SDL_Renderer* const renderer = ui->renderer;
-    TTF_Font* const font = ui->font;
+    struct ggit_vec_compressed_x* compressed_x = &ui->cache.compressed_x;
+    struct ggit_vec_int* out_columns = &ui->cache.columns;
+    int const g_width = graph->width;
+    int const g_height = graph->height;
 
-    int const i_max = min(graph->height, 15000000);
-    int* compressed_width = &ui->cache.compressed_width;
-    // Compress X
-    struct ggit_vector* compressed_x = &ui->cache.compressed_x;
-    if (compressed_x->size != graph->width) {
-        *compressed_width = ggit_ui_graph__generate_compressed_x(
-            graph,
-            0,
-            i_max,
-            compressed_x
-        );
-    }
+    ggit_graph_branch_columns(graph, &ui->cache.branch_column, &ui->cache.branch_order);
 
-    // Draw the refs.
-    ggit_ui_draw_graph__refs(
-        ui,
-        graph,
-        input,
+    ggit_vec_int_clear(out_columns);
+    ggit_vec_int_extend(out_columns, (size_t)g_height);
+
+    ggit_vec_compressed_x_clear(compressed_x);
+    memset(
+        ggit_vec_compressed_x_extend(compressed_x, (size_t)g_width),
         0,
-        i_max,
-        *compressed_width,
-        compressed_x
+        g_width * sizeof(struct compressed_x)
     );
+    for (int commit_i = 0; commit_i < g_height; ++commit_i) {
+        int x = ggit_graph_commit_column(graph, ui->cache.branch_column.data, 0, commit_i);
+        out_columns->data[commit_i] = x;
+    }
+}
+/** Redoes the raw columns once per loaded (or relabeled) graph. */
+static void
+ggit_ui_columns__sync(struct ggit_ui* ui, struct ggit_graph* graph)
+{
+    if (ui->cache.graph_revision == graph->revision)
+        return;
+    ui->cache.graph_revision = graph->revision;
+    ggit_ui_graph__generate_columns(ui, graph);
+}
+/** Whole-history compression - every column a visible commit lives in. */
+static void
+ggit_ui_graph__generate_compressed_x(struct ggit_ui* ui)
+{
+    struct ggit_vec_compressed_x* compressed_x = &ui->cache.compressed_x;
+    int const* columns = ui->cache.columns.data;
+
+    for (size_t i = 0; i < compressed_x->size; ++i)
+        compressed_x->data[i].taken = false;
+    for (int commit_i = 0; commit_i < (int)ui->cache.columns.size; ++commit_i) {
+        if (ggit_view_is_visible(&ui->view, commit_i))
+            compressed_x->data[columns[commit_i]].taken = true;
+    }
+    ui->cache.compressed_width = ggit_ui_graph__assign_compressed_x(compressed_x);
+}
+/** Packs what the render loops need about every visible row, in row order. O(rows). */
+static void
+ggit_ui_graph__generate_rows(struct ggit_ui* ui, struct ggit_graph* graph)
+{
+    struct ggit_view const* view = &ui->view;
+    struct ggit_vec_row* rows = &ui->cache.rows;
+    int const* columns = ui->cache.columns.data;
+
+    ggit_vec_row_clear(rows);
+    ggit_vec_row_extend(rows, (size_t)view->height);
+
+    // Flags coming from the refs, collected per commit first.
+    uint8_t* ref_flags = (uint8_t*)calloc(max(graph->height, 1), 1);
+    if (!ref_flags) {
+        perror("[ggit_ui_graph__generate_rows] OOM.");
+        abort();
+    }
+    for (int r = 0; r < graph->ref_commits.size; ++r) {
+        int const commit = ggit_vector_get_int(&graph->ref_commits, r);
+        if (commit == -1)
+            continue;
+        char const* name = ggit_vector_get_string(&graph->ref_names, r);
+        size_t const length = strlen(name);
+        ref_flags[commit] |= ggit_row_ref;
+        if (strcmp(name, "HEAD") == 0 || (length > 5 && strcmp(name + length - 5, "/HEAD") == 0))
+            ref_flags[commit] |= ggit_row_head;
+        if (strcmp(name, "refs/stash") == 0)
+            ref_flags[commit] |= ggit_row_stash;
+    }
 
-    // Draw spans (debug)
-    ggit_ui_draw_graph__spans(ui, graph, input, 0, i_max, compressed_x);
+    // Rows go newest first, so the folds are met from the last one down.
+    struct ggit_fold const* folds = (struct ggit_fold const*)view->folds.data;
+    int fold = view->folds.size - 1;
+
+    for (int row = 0; row < view->height; ++row) {
+        int const commit = ggit_view_commit(view, row);
+        while (fold >= 0 && folds[fold].commit > commit)
+            --fold;
+        bool const is_fold = fold >= 0 && folds[fold].commit == commit;
+        int n_parents;
+        int const* parents = ggit_parents_of(view->parents, commit, &n_parents);
+        struct ggit_commit_tag const tag = graph->tags[commit];
+
+        struct ggit_row* out = rows->data + row;
+        out->commit = commit;
+        out->message_offset = (uint32_t)(graph->messages[commit] - graph->message_store);
+        out->first_parent_delta = n_parents ? ggit_view_row(view, parents[0]) - row : 0;
+        out->column = (uint16_t)columns[commit];
+        out->instance = tag.tag[1];
+        out->branch = (int8_t)tag.tag[0];
+        out->flags = ref_flags[commit] | (n_parents > 1 ? ggit_row_merge : 0)
+                     | (is_fold ? ggit_row_fold : 0);
+    }
+    free(ref_flags);
+}
 
-    // Draw connections
-    ggit_ui_draw_graph__connections(ui, graph, 0, i_max, compressed_x);
+/** Slides the counted window of rows to [i_from, i_to) and re-compresses if needed.
+ *
+ * Only the rows entering and leaving the window are looked at - scrolling a few rows
+ * costs a few rows, not a rescan of the screen (or the history).
+ */
+static void
+ggit_ui_graph__compress_viewport(struct ggit_ui* ui, struct ggit_graph* graph, int i_from, int i_to)
+{
+    struct ggit_vec_compressed_x* compressed_x = &ui->cache.compressed_x;
+    struct ggit_vec_int* occupancy = &ui->cache.occupancy;
+    int const* columns = ui->cache.columns.data;
+    struct ggit_view const* view = &ui->view;
+    int const g_width = graph->width;
 
-    // Draw commit messages
-    ggit_ui_draw_graph__commit_messages(
-        ui,
-        graph,
-        0,
-        i_max,
-        *compressed_width,
-        compressed_x
+    bool changed = false;
+    if (occupancy->size != (size_t)g_width) {
+        ggit_vec_int_clear(occupancy);
+        memset(ggit_vec_int_extend(occupancy, (size_t)g_width), 0, g_width * sizeof(int));
+        ui->cache.window_from = ui->cache.window_to = 0;
+        changed = true;
+    }
+    int* counts = occupancy->data;
+
+    int const old_from = ui->cache.window_from;
+    int const old_to = ui->cache.window_to;
+
+#define ADD_ROWS(from, to)                                                  \
+    for (int row = (from); row < (to); ++row) {                             \
+        changed |= counts[columns[ggit_view_commit(view, row)]]++ == 0;     \
+    }
+#define REMOVE_ROWS(from, to)                                               \
+    for (int row = (from); row < (to); ++row) {                             \
+        changed |= --counts[columns[ggit_view_commit(view, row)]] == 0;     \
+    }
+
+    if (i_to <= old_from || i_from >= old_to) {
+        // No overlap - nothing to reuse.
+        REMOVE_ROWS(old_from, old_to);
+        ADD_ROWS(i_from, i_to);
+    } else {
+        REMOVE_ROWS(old_from, i_from);
+        ADD_ROWS(i_from, old_from);
+        REMOVE_ROWS(i_to, old_to);
+        ADD_ROWS(old_to, i_to);
+    }
+#undef ADD_ROWS
+#undef REMOVE_ROWS
+
+    ui->cache.window_from = i_from;
+    ui->cache.window_to = i_to;
+
+    if (!changed)
+        return;
+
+    for (int i = 0; i < g_width; ++i)
+        compressed_x->data[i].taken = counts[i] > 0;
+    ui->cache.compressed_width = ggit_ui_graph__assign_compressed_x(compressed_x);
+}
+/** Moves every column a step closer to its compressed position.
+ *
+ * Keeps the UI dirty until all of them have settled.
+ */
+static void
+ggit_ui_graph__animate_columns(struct ggit_ui* ui)
+{
+    struct ggit_vec_compressed_x* compressed_x = &ui->cache.compressed_x;
+    struct ggit_vec_f32* column_x = &ui->cache.column_x;
+    struct ggit_vec_int* offsets = &ui->cache.column_offset;
+    int const width = (int)compressed_x->size;
+    int const item_box_w = ui->item_w + ui->border * 2 + ui->margin_x * 2;
+
+    uint64_t const now = SDL_GetTicks64();
+    float const dt = (float)(now - ui->cache.animated_at);
+    ui->cache.animated_at = now;
+
+    /* Frame-rate independent easing - half of the distance every half-life. */
+    float const step = 1.0f - powf(0.5f, dt / GGIT_COLUMN_HALF_LIFE_MS);
+
+    bool snap = false;
+    if (column_x->size != (size_t)width) {
+        ggit_vec_f32_clear(column_x);
+        ggit_vec_f32_extend(column_x, (size_t)width);
+        ggit_vec_int_clear(offsets);
+        ggit_vec_int_extend(offsets, (size_t)width);
+        snap = true;
+    }
+    memset(offsets->data, 0, width * sizeof(int));
+
+    bool moving = false;
+    for (int i = 0; i < width; ++i) {
+        struct compressed_x const* cx = compressed_x->data + i;
+        float* x = column_x->data + i;
+        float const target = (float)cx->new_x;
+
+        if (snap || fabsf(target - *x) < 0.01f) {
+            *x = target;
+        } else {
+            *x += (target - *x) * step;
+            moving = true;
+        }
+
+        if (cx->taken)
+            offsets->data[cx->new_x] = (int)((*x - target) * item_box_w);
+    }
+
+    float const target_width = (float)ui->cache.compressed_width;
+    if (snap || fabsf(target_width - ui->cache.width_x) < 0.01f) {
+        ui->cache.width_x = target_width;
+    } else {
+        ui->cache.width_x += (target_width - ui->cache.width_x) * step;
+        moving = true;
+    }
+
+    if (moving)
+        ui->dirty = true;
+}
+
+/** Zoomed-out drawing - per-column density bands from the LOD pyramid, no text.
+ *
+ * The number of cells visited only depends on the screen height and the columns in
+ * view, never on the length of the history.
+ */
+static void
+ggit_ui_draw_graph__lod(
+    struct ggit_ui* ui,
+    struct ggit_graph* graph,
+    int i_from,
+    int i_to,
+    struct ggit_vec_compressed_x* compressed_x
+)
+{
+    struct ggit_lod* lod = &ui->cache.lod;
+    if (lod->revision != ui->view.serial)
+        ggit_lod_build(lod, graph, &ui->view, ui->cache.columns.data);
+    if (i_from >= i_to)
+        return;
+
+    int const graph_x = ui->graph_x;
+    int const graph_y = ui->graph_y;
+    int const ITEM_W = ui->item_w;
+    int const ITEM_BOX_H = ui->item_h + ui->border * 2 + ui->margin_y * 2;
+
+    SDL_Color const background = { 245, 245, 245, 0xFF };
+    SDL_Color const line_color = { 0xAA, 0xAA, 0xAA, 0xFF };
+
+    /* Pick the level whose buckets are at least GGIT_LOD_BAND_PX pixels tall. */
+    long long const band_rows = -floor_div(
+        -ggit_graph_pixels_to_rows(ui, GGIT_LOD_BAND_PX),
+        ITEM_BOX_H
     );
+    struct ggit_lod_level const* level = &lod->levels[ggit_lod_pick_level(
+        lod,
+        (int)min(band_rows, INT32_MAX)
+    )];
+    int const bucket_rows = level->bucket_rows;
+    int const bucket_last = (i_to - 1) / bucket_rows;
+
+    struct ggit_ui_batch* batch = &ui->batch;
+    for (int k = 0; k < lod->width; ++k) {
+        if (lod->row_max[k] < i_from || lod->row_min[k] >= i_to)
+            continue;
+        struct compressed_x const* cx = compressed_x->data + k;
+        if (!cx->taken)
+            continue;
+
+        int const x_center = graph_x + ggit_graph_commit_x_center(ui, cx->new_x);
+        int const half_w = max(1, ITEM_W / 2);
+
+        SDL_Color base = { 0x15, 0x15, 0x15, 0xFF };
+        if (lod->column_branch[k] != -1) {
+            struct ggit_special_branch* branch = ggit_vector_ref_special_branch(
+                &graph->special_branches,
+                lod->column_branch[k]
+            );
+            base = (SDL_Color){
+                branch->colors_base[0][0],
+                branch->colors_base[0][1],
+                branch->colors_base[0][2],
+                0xFF,
+            };
+        }
+
+        // The column's life line - one straight line instead of every edge in it.
+        int const row_first = max(lod->row_min[k], i_from);
+        int const row_last = min(lod->row_max[k], i_to - 1);
+        ggit_ui_batch_rect(
+            batch,
+            x_center,
+            graph_y + ggit_graph_row_y_top(ui, row_first),
+            x_center + 1,
+            graph_y + ggit_graph_row_y_top(ui, row_last + 1) + 1,
+            line_color
+        );
+
+        int const bucket_first = max(i_from / bucket_rows, level->first_bucket[k]);
+        for (int b = bucket_first; b <= bucket_last; ++b) {
+            struct ggit_lod_cell const* cell = ggit_lod_cell(level, k, b);
+            if (!cell)
+                break;
+
+            int const y0 = graph_y + ggit_graph_row_y_top(ui, b * bucket_rows);
+            int const y1 = max(
+                y0 + 1,
+                graph_y + ggit_graph_row_y_top(ui, (b + 1) * bucket_rows)
+            );
+
+            if (cell->commits) {
+                /* Share of the bucket's rows that belong to this column. */
+                float const density = (float)cell->commits / (float)bucket_rows;
+                float const t = max(0.25f, sqrtf(min(density, 1.0f)));
+                SDL_Color const color = {
+                    (Uint8)(background.r + (base.r - background.r) * t),
+                    (Uint8)(background.g + (base.g - background.g) * t),
+                    (Uint8)(background.b + (base.b - background.b) * t),
+                    0xFF,
+                };
+                ggit_ui_batch_rect(
+                    batch,
+                    x_center - half_w,
+                    y0,
+                    x_center + half_w + 1,
+                    y1,
+                    color
+                );
+            }
+
+            if (cell->edge_min <= cell->edge_max) {
+                /* All the edges leaving the bucket become one horizontal line. */
+                int const x_min = graph_x
+                                  + ggit_graph_commit_x_center(
+                                      ui,
+                                      compressed_x->data[cell->edge_min].new_x
+                                  );
+                int const x_max = graph_x
+                                  + ggit_graph_commit_x_center(
+                                      ui,
+                                      compressed_x->data[cell->edge_max].new_x
+                                  );
+                int const y_mid = (y0 + y1) / 2;
+                ggit_ui_batch_rect(
+                    batch,
+                    min(x_min, x_center),
+                    y_mid,
+                    max(x_max, x_center) + 1,
+                    y_mid + 1,
+                    line_color
+                );
+            }
+        }
+    }
+    ggit_ui_batch_flush(ui->renderer, batch);
+}
+
+static void
+ggit_ui_draw_graph__crosshair(struct ggit_ui* ui, struct ggit_input* input)
+{
+    SDL_Renderer* const renderer = ui->renderer;
 
-    // Draw the crosshair
     SDL_SetRenderDrawColor(renderer, 0x22, 0x22, 0x22, 0xFF);
-    SDL_RenderDrawLines(
+    ggit_ui_draw_lines(
         renderer,
         (SDL_Point[]){
             { 0, input->mouse_y },
@@ -929,7 +1505,7 @@ ggit_ui_draw_graph(
         },
         2
     );
-    SDL_RenderDrawLines(
+    ggit_ui_draw_lines(
         renderer,
         (SDL_Point[]){
             { input->mouse_x, 0 },
@@ -937,9 +1513,318 @@ ggit_ui_draw_graph(
         },
         2
     );
+}
+
+static void
+ggit_ui_draw_graph(
+    struct ggit_ui* ui,
+    struct ggit_input* input,
+    struct ggit_graph* graph
+)
+{
+    TTF_Font* const font = ui->font;
+
+    struct ggit_view const* view = &ui->view;
+    ggit_ui_ancestry__sync(ui, graph);
+
+    int* compressed_width = &ui->cache.compressed_width;
+    // Compress X
+    struct ggit_vec_compressed_x* compressed_x = &ui->cache.compressed_x;
+    ggit_ui_columns__sync(ui, graph);
+    if (ui->cache.view_serial != view->serial) {
+        ui->cache.view_serial = view->serial;
+        ggit_ui_graph__generate_compressed_x(ui);
+        ggit_ui_graph__generate_rows(ui, graph);
+        /* Rows moved, the counts are meaningless now. */
+        ggit_vec_int_clear(&ui->cache.occupancy);
+    }
+
+    int i_from;
+    int i_to;
+    ggit_ui_visible_rows(ui, view->height, &i_from, &i_to);
+
+    if (ui->cache.compress_viewport)
+        ggit_ui_graph__compress_viewport(ui, graph, i_from, i_to);
+    ggit_ui_graph__animate_columns(ui);
+    /* Text follows the columns while they move. */
+    int const text_width = (int)ceilf(ui->cache.width_x);
+
+    if (ggit_ui_is_zoomed_out(ui)) {
+        ggit_profile_pass_begin(ggit_profile_pass_lod);
+        ggit_ui_draw_graph__lod(ui, graph, i_from, i_to, compressed_x);
+        ggit_profile_pass_end(ggit_profile_pass_lod);
+
+        ggit_ui_draw_graph__crosshair(ui, input);
+        return;
+    }
+
+    /* NOTE(boz):
+        Edges are drawn from the child, so children above the screen whose edges
+        come down into it have to be visited too. graph->reach says how far up
+        those can be.
+    */
+    int connections_from = i_from;
+    if (i_from < i_to) {
+        int const newest_visible = ggit_view_commit(view, i_from);
+        connections_from = ggit_view_row(view, view->reach[newest_visible]);
+    }
+
+    // Draw the refs.
+    ggit_profile_pass_begin(ggit_profile_pass_refs);
+    ggit_ui_draw_graph__refs(
+        ui,
+        graph,
+        input,
+        i_from,
+        i_to,
+        *compressed_width,
+        compressed_x
+    );
+    ggit_profile_pass_end(ggit_profile_pass_refs);
+
+    // Draw spans (debug)
+    ggit_profile_pass_begin(ggit_profile_pass_spans);
+    ggit_ui_draw_graph__spans(ui, graph, input, i_from, i_to, compressed_x);
+    ggit_profile_pass_end(ggit_profile_pass_spans);
+
+    // Draw connections
+    ggit_profile_pass_begin(ggit_profile_pass_connections);
+    ggit_ui_draw_graph__connections(ui, graph, connections_from, i_to, compressed_x);
+    ggit_profile_pass_end(ggit_profile_pass_connections);
+
+    // Draw commit messages
+    ggit_profile_pass_begin(ggit_profile_pass_commit_messages);
+    ggit_ui_draw_graph__commit_messages(
+        ui,
+        graph,
+        i_from,
+        i_to,
+        text_width,
+        compressed_x
+    );
+    ggit_profile_pass_end(ggit_profile_pass_commit_messages);
+
+    // Draw the crosshair
+    ggit_ui_draw_graph__crosshair(ui, input);
 
     // Draw the blocks.
-    ggit_ui_draw_graph__boxes(ui, graph, 0, i_max, compressed_x);
+    ggit_profile_pass_begin(ggit_profile_pass_boxes);
+    ggit_ui_draw_graph__boxes(ui, graph, i_from, i_to, compressed_x);
+    ggit_profile_pass_end(ggit_profile_pass_boxes);
+}
+
+/** What the graph and the UI hold right now, by tag. O(special branches), cheap enough per frame. */
+static void
+ggit_ui_memory_report(
+    struct ggit_ui const* ui,
+    struct ggit_graph const* graph,
+    struct ggit_memory_report* report
+)
+{
+    memset(report, 0, sizeof(*report));
+    ggit_graph_memory_report(graph, report);
+    size_t* const bytes = report->bytes;
+
+    bytes[ggit_memory_render] += ggit_view_memory_usage(&ui->view);
+    bytes[ggit_memory_render] += ggit_vec_compressed_x_memory_usage(&ui->cache.compressed_x);
+    bytes[ggit_memory_render] += ggit_vec_int_memory_usage(&ui->cache.columns);
+    bytes[ggit_memory_render] += ggit_vec_int_memory_usage(&ui->cache.branch_column);
+    bytes[ggit_memory_render] += ggit_vec_int_memory_usage(&ui->cache.branch_order);
+    bytes[ggit_memory_render] += ggit_vec_row_memory_usage(&ui->cache.rows);
+    bytes[ggit_memory_render] += ggit_vec_int_memory_usage(&ui->cache.occupancy);
+    bytes[ggit_memory_render] += ggit_vec_f32_memory_usage(&ui->cache.column_x);
+    bytes[ggit_memory_render] += ggit_vec_int_memory_usage(&ui->cache.column_offset);
+    bytes[ggit_memory_render] += ggit_lod_memory_usage(&ui->cache.lod);
+    bytes[ggit_memory_render] += ggit_vec_vertex_memory_usage(&ui->batch.vertices);
+    bytes[ggit_memory_render] += ggit_vec_int_memory_usage(&ui->batch.indices);
+
+    bytes[ggit_memory_text] += ui->labels.texture_bytes;
+    bytes[ggit_memory_text] += ggit_vec_size_memory_usage(&ui->labels.sizes);
+    bytes[ggit_memory_text] += ggit_vec_texture_memory_usage(&ui->labels.textures);
+    if (ui->hud.text)
+        bytes[ggit_memory_text] += (size_t)ui->hud.text_size.w * ui->hud.text_size.h * 4;
+
+    bytes[ggit_memory_metadata] += ggit_filter_index_memory_usage(&ui->filter.index);
+
+    bytes[ggit_memory_other] += ggit_bitset_memory_usage(&ui->filter.commits);
+    bytes[ggit_memory_other] += ggit_bitset_memory_usage(&ui->search.matches);
+    bytes[ggit_memory_other] += ggit_bitset_memory_usage(&ui->select.selected);
+    bytes[ggit_memory_other] += ggit_vector_memory_usage(&ui->select.picked);
+    bytes[ggit_memory_other] += ggit_ancestry_memory_usage(&ui->ancestry.engine);
+    bytes[ggit_memory_other] += ggit_vector_memory_usage(&ui->ancestry.contains);
+}
+static void
+ggit_ui_print_memory(struct ggit_ui const* ui, struct ggit_graph const* graph)
+{
+    struct ggit_memory_report report;
+    ggit_ui_memory_report(ui, graph, &report);
+    ggit_memory_print(&report, stdout);
+}
+static void
+ggit_ui_draw_profiler__refresh_text(struct ggit_ui* ui, struct ggit_graph* graph)
+{
+    /* NOTE(boz):
+        The HUD shows the previous frame - the current one is still being timed.
+    */
+    int const last = (ggit_profiler.frames + GGIT_PROFILE_HISTORY - 1)
+                     % GGIT_PROFILE_HISTORY;
+    struct ggit_profile_frame const* frame = &ggit_profiler.history[last];
+
+    char text[2048];
+    int length = snprintf(
+        text,
+        sizeof(text),
+        "frame %.2f ms   p50 %.2f   p99 %.2f\n",
+        frame->frame_ms,
+        ggit_profile_percentile(0.50f),
+        ggit_profile_percentile(0.99f)
+    );
+    for (int p = 0; p < ggit_profile_pass_count; ++p) {
+        length += snprintf(
+            text + length,
+            sizeof(text) - length,
+            "%-16s %6.3f ms\n",
+            ggit_profile_pass_name(p),
+            frame->pass_ms[p]
+        );
+    }
+    length += snprintf(
+        text + length,
+        sizeof(text) - length,
+        "draws %d   vertices %d\ngraph %d commits (%d shown)\n",
+        frame->draw_calls,
+        frame->vertices,
+        graph->height,
+        ui->view.height
+    );
+    ggit_memory_format(&frame->memory, text + length, sizeof(text) - length);
+
+    if (ui->hud.text)
+        SDL_DestroyTexture(ui->hud.text);
+    ui->hud.text = ggit_ui_create_text_texture(
+        ui->renderer,
+        ui->font,
+        text,
+        &ui->hud.text_size
+    );
+}
+static void
+ggit_ui_draw_profiler(struct ggit_ui* ui, struct ggit_graph* graph)
+{
+    SDL_Renderer* const renderer = ui->renderer;
+
+    uint64_t const now = SDL_GetTicks64();
+    if (!ui->hud.text || now - ui->hud.refreshed_at >= GGIT_HUD_REFRESH_MS) {
+        ui->hud.refreshed_at = now;
+        ggit_ui_draw_profiler__refresh_text(ui, graph);
+    }
+
+    int const graph_w = GGIT_PROFILE_HISTORY;
+    int const graph_h = 60;
+    int const hud_w = max(ui->hud.text_size.w, graph_w);
+    int const hud_x = ui->screen_w - hud_w - 8;
+    int const hud_y = 8;
+    int const graph_y = hud_y + ui->hud.text_size.h + 4;
+
+    SDL_SetRenderDrawColor(renderer, 220, 220, 220, 0xFF);
+    SDL_RenderFillRect(
+        renderer,
+        &(SDL_Rect){ hud_x - 4, hud_y - 4, hud_w + 8, graph_y + graph_h + 8 - hud_y }
+    );
+    ggit_profile_count_draw(4);
+
+    if (ui->hud.text) {
+        SDL_RenderCopy(
+            renderer,
+            ui->hud.text,
+            NULL,
+            &(SDL_Rect){ hud_x, hud_y, ui->hud.text_size.w, ui->hud.text_size.h }
+        );
+        ggit_profile_count_draw(4);
+    }
+
+    /* Rolling frame times, oldest on the left. 33ms is the top of the graph. */
+    SDL_Point points[GGIT_PROFILE_HISTORY];
+    int const n = min(ggit_profiler.frames, GGIT_PROFILE_HISTORY);
+    int const first = ggit_profiler.frames - n;
+    for (int i = 0; i < n; ++i) {
+        float ms = ggit_profiler.history[(first + i) % GGIT_PROFILE_HISTORY].frame_ms;
+        int h = (int)(min(ms, 33.0f) * graph_h / 33.0f);
+        points[i] = (SDL_Point){ hud_x + i, graph_y + graph_h - h };
+    }
+
+    SDL_SetRenderDrawColor(renderer, 0xAA, 0xAA, 0xAA, 0xFF);
+    int const y_16ms = graph_y + graph_h - graph_h * 16 / 33;
+    ggit_ui_draw_line(renderer, hud_x, y_16ms, hud_x + graph_w, y_16ms);
+    SDL_SetRenderDrawColor(renderer, 0xE6, 0x00, 0x00, 0xFF);
+    if (n > 1)
+        ggit_ui_draw_lines(renderer, points, n);
+}
+
+/** Re-sizes the selection when a new graph was loaded - old rows mean nothing now. */
+static void
+ggit_ui_select__sync(struct ggit_ui* ui, struct ggit_graph* graph)
+{
+    if (ui->select.graph_revision == graph->revision
+        && ui->select.selected.size == graph->height)
+        return;
+
+    ui->select.graph_revision = graph->revision;
+    ggit_bitset_resize(&ui->select.selected, graph->height);
+    ggit_vector_clear(&ui->select.picked);
+    ui->select.active_commit = -1;
+    ui->select.anchor_commit = -1;
+}
+static void
+ggit_ui_select_clear(struct ggit_ui* ui)
+{
+    ggit_bitset_clear(&ui->select.selected);
+    ggit_vector_clear(&ui->select.picked);
+    ui->select.active_commit = -1;
+    ui->select.anchor_commit = -1;
+}
+static void
+ggit_ui_select__unpick(struct ggit_ui* ui, int commit_i)
+{
+    struct ggit_vector* picked = &ui->select.picked;
+    for (int i = 0; i < picked->size; ++i) {
+        if (ggit_vector_get_int(picked, i) == commit_i) {
+            memmove(
+                ggit_vector_get(picked, i),
+                ggit_vector_get(picked, i + 1),
+                (picked->size - i - 1) * picked->value_size
+            );
+            picked->size -= 1;
+            break;
+        }
+    }
+}
+static void
+ggit_ui_select_toggle(struct ggit_ui* ui, int commit_i)
+{
+    ggit_bitset_flip(&ui->select.selected, commit_i);
+
+    if (ggit_bitset_test(&ui->select.selected, commit_i)) {
+        ggit_vector_push(&ui->select.picked, &commit_i);
+        ui->select.active_commit = commit_i;
+        ui->select.anchor_commit = commit_i;
+        return;
+    }
+
+    struct ggit_vector* picked = &ui->select.picked;
+    ggit_ui_select__unpick(ui, commit_i);
+    int const last = picked->size ? ggit_vector_get_int(picked, picked->size - 1) : -1;
+    ui->select.active_commit = last;
+    ui->select.anchor_commit = last;
+}
+/* Makes an already selected commit the active one, and the anchor of the next range. */
+static void
+ggit_ui_select_pick(struct ggit_ui* ui, int commit_i)
+{
+    ggit_ui_select__unpick(ui, commit_i);
+    ggit_vector_push(&ui->select.picked, &commit_i);
+    ui->select.active_commit = commit_i;
+    ui->select.anchor_commit = commit_i;
 }
 
 static bool
@@ -982,7 +1867,7 @@ ggit_ui_draw_overlay__create_selection(
 
     };
     SDL_SetRenderDrawColor(ui->renderer, 0x50, 0x50, 0x50, 0xFF);
-    SDL_RenderDrawLines(ui->renderer, points, ARRAY_COUNT(points));
+    ggit_ui_draw_lines(ui->renderer, points, ARRAY_COUNT(points));
     return true;
 }
 static bool
@@ -992,82 +1877,31 @@ ggit_ui_draw_overlay__drag_selection(
     struct ggit_graph* graph
 )
 {
-    if (ui->select.selected_commits.size == 0) {
-        return false;
-    }
-
-    int const graph_x = ui->graph_x;
-    int const graph_y = ui->graph_y;
-    int const G_WIDTH = graph->width;
-    int const G_HEIGHT = graph->height;
-
-    int const SCREEN_W = ui->screen_w;
-    int const SCREEN_H = ui->screen_h;
-    int const ITEM_W = ui->item_w;
-    int const ITEM_H = ui->item_h;
-    int const BORDER = ui->border;
-    int const MARGIN_X = ui->margin_x;
-    int const MARGIN_Y = ui->margin_y;
-
-    int const ITEM_OUTER_W = ITEM_W + BORDER * 2;
-    int const ITEM_OUTER_H = ITEM_H + BORDER * 2;
-    int const ITEM_BOX_W = ITEM_OUTER_W + MARGIN_X * 2;
-    int const ITEM_BOX_H = ITEM_OUTER_H + MARGIN_Y * 2;
-
     int const start_x = ui->select.start_x;
     int const start_y = ui->select.start_y;
-    int const end_x = ui->select.end_x;
-    int const end_y = ui->select.end_y;
-
-
-    int const n_selected = ui->select.selected_commits.size;
-    for (int i = 0; i < n_selected; ++i) {
-        int const commit_i = ggit_vector_get_int(&ui->select.selected_commits, i);
-        int const column = ggit_graph_commit_column(
-            graph,
-            &ui->cache.compressed_x,
-            commit_i
-        );
-
-        int const commit_x_left = graph_x + MARGIN_X + BORDER
-                                  + ggit_graph_commit_x_left(ui, column);
-        int const commit_y_top = graph_y + MARGIN_Y + BORDER
-                                 + ggit_graph_commit_y_top(ui, commit_i, G_HEIGHT);
-        int const commit_x_right = commit_x_left + ITEM_W;
-        int const commit_y_bottom = commit_y_top + ITEM_H;
-
-        if (point_in_rect(
-                commit_x_left,
-                commit_y_top,
-                commit_x_right,
-                commit_y_bottom,
-                start_x,
-                start_y
-            )) {
-            goto found;
-        }
-    }
-    goto not_found;
 
-found:;
-    {
-        /* We found a commit that is starting to get dragged. */
+    int const dragged = ggit_graph_commit_at(
+        ui,
+        graph,
+        &ui->cache.compressed_x,
+        start_x,
+        start_y
+    );
+    if (dragged == -1 || !ggit_bitset_test(&ui->select.selected, dragged))
+        return false;
 
-        int offset_x = 0;
-        int offset_y = 0;
+    /* We found a commit that is starting to get dragged. */
+    int offset_x = 0;
+    int offset_y = 0;
 
-        ui->graph_x += offset_x;
-        ui->graph_y += offset_y;
+    ui->graph_x += offset_x;
+    ui->graph_y += offset_y;
 
-        /* TODO: draw the boxes. */
+    /* TODO: draw the boxes. */
 
-        ui->graph_x -= offset_x;
-        ui->graph_y -= offset_y;
-    }
+    ui->graph_x -= offset_x;
+    ui->graph_y -= offset_y;
     return true;
-
-not_found:;
-    return false;
 }
 
 static void
@@ -1089,6 +1923,8 @@ ggit_ui_draw_overlay(
     }
 
     // Selections
+    ggit_ui_select__sync(ui, graph);
+    ggit_ui_columns__sync(ui, graph);
     int const lmb = input->buttons[0];
     if (lmb & 1) {
         ggit_ui_draw_overlay__drag_selection(ui, input, graph)
@@ -1096,100 +1932,413 @@ ggit_ui_draw_overlay(
     } else if (ui->select.start_x >= 0) {
         // End selection
 
-        int const graph_x = ui->graph_x;
-        int const graph_y = ui->graph_y;
-        int const G_WIDTH = graph->width;
-        int const G_HEIGHT = graph->height;
-
-        int const SCREEN_W = ui->screen_w;
-        int const SCREEN_H = ui->screen_h;
-        int const ITEM_W = ui->item_w;
-        int const ITEM_H = ui->item_h;
-        int const BORDER = ui->border;
-        int const MARGIN_X = ui->margin_x;
-        int const MARGIN_Y = ui->margin_y;
-
-        int const ITEM_OUTER_W = ITEM_W + BORDER * 2;
-        int const ITEM_OUTER_H = ITEM_H + BORDER * 2;
-        int const ITEM_BOX_W = ITEM_OUTER_W + MARGIN_X * 2;
-        int const ITEM_BOX_H = ITEM_OUTER_H + MARGIN_Y * 2;
-
         int const start_x = ui->select.start_x;
         int const start_y = ui->select.start_y;
         int const end_x = ui->select.end_x;
         int const end_y = ui->select.end_y;
 
-        ggit_vector_clear(&ui->select.selected_commits);
-        ui->select.active_commit = 0;
+        /* NOTE(boz):
+            CTRL adds to (or toggles inside) the current selection,
+            SHIFT selects the whole row range between the anchor and the click.
+        */
+        bool const additive = input->is_ctrl_down;
         if (start_x == end_x && start_y == end_y) {
-            for (int i = G_HEIGHT - 1; i >= 0; --i) {
-                int const commit_i = G_HEIGHT - i - 1;
-                int const column = ggit_graph_commit_column(
-                    graph,
-                    &ui->cache.compressed_x,
-                    commit_i
+            int const commit_i = ggit_graph_commit_at(
+                ui,
+                graph,
+                &ui->cache.compressed_x,
+                start_x,
+                start_y
+            );
+            int const anchor = ui->select.anchor_commit;
+
+            if (commit_i != -1 && anchor != -1 && input->is_shift_down) {
+                if (!additive)
+                    ggit_bitset_clear(&ui->select.selected);
+                ggit_bitset_set_range(
+                    &ui->select.selected,
+                    min(anchor, commit_i),
+                    max(anchor, commit_i) + 1
                 );
-
-                int const commit_x_left = graph_x + MARGIN_X + BORDER
-                                          + ggit_graph_commit_x_left(ui, column);
-                int const commit_y_top = graph_y + MARGIN_Y + BORDER
-                                         + ggit_graph_commit_y_top(
-                                             ui,
-                                             commit_i,
-                                             G_HEIGHT
-                                         );
-                int const commit_x_right = commit_x_left + ITEM_W;
-                int const commit_y_bottom = commit_y_top + ITEM_H;
-
-                if (commit_y_bottom <= 0 || commit_y_top >= ui->screen_h)
-                    continue;
-
-                if (point_in_rect(
-                        commit_x_left,
-                        commit_y_top,
-                        commit_x_right,
-                        commit_y_bottom,
-                        start_x,
-                        start_y
-                    )) {
-                    ggit_vector_push(&ui->select.selected_commits, &commit_i);
-                }
+                /* Commits the filter hides are in the range but not on screen. */
+                if (ui->view.filtered)
+                    ggit_bitset_and(&ui->select.selected, &ui->view.visible);
+                ui->select.active_commit = commit_i;
+            } else if (commit_i != -1 && additive) {
+                ggit_ui_select_toggle(ui, commit_i);
+            } else {
+                ggit_ui_select_clear(ui);
+                if (commit_i != -1)
+                    ggit_ui_select_toggle(ui, commit_i);
             }
         } else {
-            for (int i = G_HEIGHT - 1; i >= 0; --i) {
-                int const commit_i = G_HEIGHT - i - 1;
-                int const column = ggit_graph_commit_column(
-                    graph,
-                    &ui->cache.compressed_x,
-                    commit_i
-                );
-
-                int const commit_x = graph_x + ggit_graph_commit_x_center(ui, column);
-                int const commit_y = graph_y
-                                     + ggit_graph_commit_y_center(
-                                         ui,
-                                         commit_i,
-                                         G_HEIGHT
-                                     );
-                if (commit_y < -ITEM_H || commit_y > ui->screen_h)
-                    continue;
-
-                if (point_in_rect(
-                        ui->select.start_x,
-                        ui->select.start_y,
-                        ui->select.end_x,
-                        ui->select.end_y,
-                        commit_x,
-                        commit_y
-                    )) {
-                    ggit_vector_push(&ui->select.selected_commits, &commit_i);
-                }
-            }
+            if (!additive)
+                ggit_ui_select_clear(ui);
+            int const end_commit = ggit_graph_commits_in_rect(
+                ui,
+                graph,
+                &ui->cache.compressed_x,
+                start_x,
+                start_y,
+                end_x,
+                end_y,
+                &ui->select.selected
+            );
+            /* Like a click on the commit where the rectangle ended - SHIFT continues from it. */
+            if (end_commit != -1)
+                ggit_ui_select_pick(ui, end_commit);
         }
         ui->select.start_x = -1;
         ui->select.start_y = -1;
     }
 }
+static void
+ggit_ui_toggle_viewport_compression(struct ggit_ui* ui)
+{
+    ui->cache.compress_viewport = !ui->cache.compress_viewport;
+    /* Start counting from scratch next time it gets turned on. */
+    ggit_vec_int_clear(&ui->cache.occupancy);
+    if (ui->cache.compress_viewport)
+        return;
+
+    ggit_ui_graph__generate_compressed_x(ui);
+}
+
+/** Rebuilds the view when the graph was reloaded or the filter changed. Never runs git. */
+static void
+ggit_ui_view__sync(struct ggit_ui* ui, struct ggit_graph* graph)
+{
+    if (ui->view.revision == graph->revision && !ui->filter.dirty)
+        return;
+    ui->filter.dirty = false;
+
+    int const fold_min = ui->filter.fold ? GGIT_VIEW_FOLD_MIN : 0;
+    if (ggit_filter_is_empty(&ui->filter.spec)) {
+        ggit_view_build(&ui->view, graph, 0, fold_min);
+        return;
+    }
+    if (ui->filter.index.revision != graph->revision)
+        ggit_filter_index_build(&ui->filter.index, graph);
+    ggit_filter_apply(&ui->filter.index, graph, &ui->filter.spec, &ui->filter.commits);
+    ggit_view_build(&ui->view, graph, &ui->filter.commits, fold_min);
+}
+static void
+ggit_ui_toggle_folds(struct ggit_ui* ui)
+{
+    ui->filter.fold = !ui->filter.fold;
+    ui->filter.dirty = true;
+}
+
+/** Centers the commit's row on screen. */
+static void
+ggit_ui_scroll_to_commit(struct ggit_ui* ui, int commit)
+{
+    int const item_box_h = ui->item_h + ui->border * 2 + ui->margin_y * 2;
+    int const row = ggit_view_row(&ui->view, commit);
+    ui->graph_y = ui->screen_h / 2 - ggit_graph_row_y_top(ui, row) - item_box_h / 2;
+    ui->dirty = true;
+}
+
+/** Restarts the search for the query. Runs on every keystroke, the old one is dropped. */
+static void
+ggit_ui_search_update(struct ggit_ui* ui, struct ggit_graph* graph, char const* query)
+{
+    /* NOTE(boz):
+        "/pattern" is a regular expression, otherwise case only matters
+        when the query has an upper case letter in it.
+    */
+    enum ggit_search_mode mode = ggit_search_nocase;
+    char const* pattern = query;
+    if (query[0] == '/') {
+        mode = ggit_search_regex;
+        pattern = query + 1;
+    } else {
+        for (char const* c = query; *c; ++c) {
+            if (isupper((unsigned char)*c))
+                mode = ggit_search_substring;
+        }
+    }
+
+    snprintf(ui->search.query, sizeof(ui->search.query), "%s", query);
+    ui->search.current = -1;
+    ui->prompt.error = !ggit_search_start(&ui->search.engine, graph, mode, pattern);
+}
+/** Picks up the matches the workers found since the last frame. */
+static void
+ggit_ui_search__sync(struct ggit_ui* ui, struct ggit_graph* graph)
+{
+    if (ui->search.matches.size != graph->height) {
+        ggit_bitset_resize(&ui->search.matches, graph->height);
+        ui->search.current = -1;
+    }
+    ggit_search_collect(&ui->search.engine, &ui->search.matches, &ui->search.running);
+    if (ui->search.running)
+        ui->dirty = true;
+}
+/** Moves to the next match down the screen (direction > 0) or up, wrapping around. */
+static void
+ggit_ui_search_step(struct ggit_ui* ui, int direction)
+{
+    struct ggit_bitset const* matches = &ui->search.matches;
+    int const start = ui->search.current;
+
+    int c = start;
+    for (int wrapped = 0; wrapped < 2;) {
+        if (direction > 0)
+            c = ggit_bitset_prev(matches, (c == -1 ? matches->size : c) - 1);
+        else
+            c = ggit_bitset_next(matches, c + 1);
+
+        if (c == -1)
+            ++wrapped;
+        else if (ggit_view_is_visible(&ui->view, c))
+            break;
+        else if (c == start)
+            c = -1;
+    }
+    if (c == -1)
+        return;
+
+    ui->search.current = c;
+    ggit_ui_scroll_to_commit(ui, c);
+}
+
+static void
+ggit_ui_prompt_open(struct ggit_ui* ui, enum ggit_prompt_kind kind)
+{
+    ui->prompt.kind = kind;
+    ui->prompt.text[0] = '\0';
+    ui->prompt.length = 0;
+    ui->prompt.error = false;
+    ui->prompt.message = 0;
+    if (kind == ggit_prompt_search) {
+        snprintf(ui->prompt.text, sizeof(ui->prompt.text), "%s", ui->search.query);
+        ui->prompt.length = (int)strlen(ui->prompt.text);
+    }
+    SDL_StartTextInput();
+}
+static void
+ggit_ui_prompt_close(struct ggit_ui* ui)
+{
+    ui->prompt.kind = ggit_prompt_none;
+    SDL_StopTextInput();
+}
+/* The text changed - searches follow every keystroke. */
+static void
+ggit_ui_prompt__changed(struct ggit_ui* ui, struct ggit_graph* graph)
+{
+    ui->prompt.error = false;
+    ui->prompt.message = 0;
+    if (ui->prompt.kind == ggit_prompt_search)
+        ggit_ui_search_update(ui, graph, ui->prompt.text);
+}
+static void
+ggit_ui_prompt_type(struct ggit_ui* ui, struct ggit_graph* graph, char const* text)
+{
+    int const length = (int)strlen(text);
+    if (ui->prompt.length + length >= (int)sizeof(ui->prompt.text))
+        return;
+    memcpy(ui->prompt.text + ui->prompt.length, text, length + 1);
+    ui->prompt.length += length;
+    ggit_ui_prompt__changed(ui, graph);
+}
+static void
+ggit_ui_prompt_backspace(struct ggit_ui* ui, struct ggit_graph* graph)
+{
+    // Drop a whole UTF-8 sequence, not just its last byte.
+    int length = ui->prompt.length;
+    while (length > 0 && (ui->prompt.text[length - 1] & 0xC0) == 0x80)
+        --length;
+    ui->prompt.length = max(0, length - 1);
+    ui->prompt.text[ui->prompt.length] = '\0';
+    ggit_ui_prompt__changed(ui, graph);
+}
+/** Scrolls to and selects the commit with the pasted (abbreviated) hash. */
+static bool
+ggit_ui_jump_to_hash(struct ggit_ui* ui, struct ggit_graph* graph, char const* text)
+{
+    while (*text == ' ')
+        ++text;
+    int length = 0;
+    while (text[length] && text[length] != ' ')
+        ++length;
+
+    int const commit = ggit_graph_find_commit(graph, text, length);
+    if (commit == -1) {
+        ui->prompt.message = "no such commit";
+        return false;
+    }
+    if (commit == -2) {
+        ui->prompt.message = "ambiguous prefix";
+        return false;
+    }
+    if (!ggit_view_is_visible(&ui->view, commit) && ui->view.folds.size) {
+        /* Might be folded away, unfold everything and look again. */
+        ui->filter.fold = false;
+        ui->filter.dirty = true;
+        ggit_ui_view__sync(ui, graph);
+    }
+    if (!ggit_view_is_visible(&ui->view, commit)) {
+        ui->prompt.message = "hidden by the filter";
+        return false;
+    }
+
+    ggit_ui_select__sync(ui, graph);
+    ggit_ui_select_clear(ui);
+    ggit_ui_select_toggle(ui, commit);
+    ggit_ui_scroll_to_commit(ui, commit);
+    return true;
+}
+/* The child continuing the commit's first-parent chain, else its oldest child. -1 if none. */
+static int
+ggit_graph_next_child(struct ggit_graph const* graph, int commit)
+{
+    int n_children;
+    int const* children = ggit_graph_children(graph, commit, &n_children);
+    for (int i = 0; i < n_children; ++i) {
+        if (ggit_parents_first(&graph->parents, children[i]) == commit)
+            return children[i];
+    }
+    return n_children ? children[0] : -1;
+}
+/** Moves the active commit one step along its chain - down to the first parent, up to a child.
+ *
+ * Hidden commits are stepped over, the view has already rewired the parents around them.
+ */
+static void
+ggit_ui_select_step(struct ggit_ui* ui, struct ggit_graph* graph, int direction)
+{
+    ggit_ui_select__sync(ui, graph);
+    int const active = ui->select.active_commit;
+    if (active == -1)
+        return;
+
+    int next = active;
+    if (direction > 0) {
+        next = ggit_parents_first(ui->view.parents, active);
+    } else {
+        do
+            next = ggit_graph_next_child(graph, next);
+        while (next != -1 && !ggit_view_is_visible(&ui->view, next));
+    }
+    if (next == -1)
+        return;
+
+    ggit_ui_select_clear(ui);
+    ggit_ui_select_toggle(ui, next);
+
+    // Only scroll when the step walked off the screen.
+    int const item_box_h = ui->item_h + ui->border * 2 + ui->margin_y * 2;
+    int const y = ui->graph_y + ggit_graph_commit_y_top(ui, next);
+    if (y < 0 || y + item_box_h > ui->screen_h)
+        ggit_ui_scroll_to_commit(ui, next);
+    ui->dirty = true;
+}
+/* Highlights everything built on top of the active commit - or stops highlighting it. */
+static void
+ggit_ui_toggle_descendants(struct ggit_ui* ui)
+{
+    int const active = ui->select.active_commit;
+    if (ui->ancestry.descendants && ui->ancestry.root == active) {
+        ui->ancestry.root = -1;
+    } else if (active != -1) {
+        ui->ancestry.root = active;
+        ui->ancestry.descendants = true;
+    }
+    ui->dirty = true;
+}
+static void
+ggit_ui_prompt_submit(struct ggit_ui* ui, struct ggit_graph* graph, bool shift)
+{
+    switch (ui->prompt.kind) {
+        case ggit_prompt_filter: {
+            struct ggit_filter spec;
+            if (!ggit_filter_parse(&spec, ui->prompt.text)) {
+                ui->prompt.error = true;
+                return;
+            }
+            ui->filter.spec = spec;
+            ui->filter.dirty = true;
+        } break;
+        case ggit_prompt_search:
+            /* Stays open - Enter / Shift+Enter walk the matches. */
+            ggit_ui_search_step(ui, shift ? -1 : +1);
+            return;
+        case ggit_prompt_jump:
+            if (!ggit_ui_jump_to_hash(ui, graph, ui->prompt.text)) {
+                ui->prompt.error = true;
+                return;
+            }
+            break;
+        default: break;
+    }
+    ggit_ui_prompt_close(ui);
+}
+static void
+ggit_ui_draw_prompt(struct ggit_ui* ui)
+{
+    if (ui->prompt.kind == ggit_prompt_none)
+        return;
+
+    int const height = TTF_FontHeight(ui->font) + 6;
+    SDL_Rect const bar = { 0, ui->screen_h - height, ui->screen_w, height };
+    if (ui->prompt.error)
+        SDL_SetRenderDrawColor(ui->renderer, 0xE6, 0x00, 0x00, 0xFF);
+    else
+        SDL_SetRenderDrawColor(ui->renderer, 0xAA, 0xAA, 0xAA, 0xFF);
+    SDL_RenderFillRect(ui->renderer, &bar);
+
+    char label[128];
+    switch (ui->prompt.kind) {
+        case ggit_prompt_filter:
+            snprintf(
+                label,
+                sizeof(label),
+                "filter (author:<name> since:<YYYY-MM-DD> until:<YYYY-MM-DD>): "
+            );
+            break;
+        case ggit_prompt_search:
+            snprintf(
+                label,
+                sizeof(label),
+                "search (%d matches%s, /regex): ",
+                ggit_bitset_count(&ui->search.matches),
+                ui->search.running ? "..." : ""
+            );
+            break;
+        case ggit_prompt_jump:
+            snprintf(
+                label,
+                sizeof(label),
+                "jump to hash%s%s: ",
+                ui->prompt.message ? " - " : "",
+                ui->prompt.message ? ui->prompt.message : ""
+            );
+            break;
+        default: label[0] = '\0'; break;
+    }
+
+    char line[512];
+    snprintf(line, sizeof(line), "%s%s_", label, ui->prompt.text);
+    ggit_ui_draw_text(ui->renderer, ui->font, line, 4, bar.y + 3, 0);
+}
+/** Re-reads the branch config and lays the loaded commits out again, git isn't run. */
+static void
+ggit_ui_reload_branches(struct ggit_graph* graph)
+{
+    if (ggit_graph_load_config(graph, GGIT_BRANCH_CONFIG) == 0)
+        ggit_graph_relabel(graph);
+}
+/** Reloads the graph. Nothing may still be reading the old one. */
+static void
+ggit_ui_reload(struct ggit_ui* ui, struct ggit_graph* graph, char const* path)
+{
+    ggit_search_cancel(&ui->search.engine);
+    ggit_graph_load(graph, path);
+    if (ui->print_memory)
+        ggit_ui_print_memory(ui, graph);
+}
+
 static void
 ggit_ui_input(struct ggit_ui* ui, struct ggit_input* input, struct ggit_graph* graph)
 {
@@ -1205,11 +2354,50 @@ main(int argc, char** argv)
     struct ggit_input input = { 0 };
     struct ggit_ui ui = { 0 };
 
-    if (!ui.select.selected_commits.value_size)
-        ggit_vector_init(&ui.select.selected_commits, sizeof(int));
+    ggit_lod_init(&ui.cache.lod);
+    ggit_ui_batch_init(&ui.batch);
+    ggit_vec_compressed_x_init(&ui.cache.compressed_x);
+    ggit_vec_int_init(&ui.cache.columns);
+    ggit_vec_int_init(&ui.cache.branch_column);
+    ggit_vec_int_init(&ui.cache.branch_order);
+    ggit_vec_row_init(&ui.cache.rows);
+    ggit_vec_int_init(&ui.cache.occupancy);
+    ggit_vec_f32_init(&ui.cache.column_x);
+    ggit_vec_int_init(&ui.cache.column_offset);
+    ui.cache.graph_revision = -1;
+    ui.cache.view_serial = -1;
+    ggit_view_init(&ui.view);
+    ggit_filter_index_init(&ui.filter.index);
+    ggit_bitset_init(&ui.filter.commits);
+    ggit_bitset_init(&ui.search.matches);
+    ggit_vec_size_init(&ui.labels.sizes);
+    ggit_vec_texture_init(&ui.labels.textures);
+    ui.labels.graph_revision = -1;
+    ggit_ancestry_init(&ui.ancestry.engine);
+    ggit_vector_init(&ui.ancestry.contains, sizeof(int8_t));
+    ui.ancestry.graph_revision = -1;
+    ui.search.current = -1;
+    ggit_bitset_init(&ui.select.selected);
+    ggit_vector_init(&ui.select.picked, sizeof(int));
+    ui.select.graph_revision = -1;
+
+    /* NOTE(boz): --memory prints where the memory goes after every load and on exit. */
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--memory") == 0)
+            ui.print_memory = true;
+        else
+            fprintf(stderr, "Ignoring unknown argument %s.\n", argv[i]);
+    }
 
     SDL_Init(SDL_INIT_VIDEO | SDL_INIT_EVENTS);
     TTF_Init();
+    ggit_search_init(&ui.search.engine);
+    ggit_profile_init();
+    /* NOTE(boz):
+        Pace presents to the display by default.
+        Can be turned off with SDL_RENDER_VSYNC=0 in the environment.
+    */
+    SDL_SetHint(SDL_HINT_RENDER_VSYNC, "1");
     SDL_Window* window;
     SDL_Renderer* renderer;
     SDL_CreateWindowAndRenderer(
@@ -1245,35 +2433,35 @@ main(int argc, char** argv)
     struct ggit_graph graph;
     ggit_graph_init(&graph);
 
-    // clang-format off
-    ggit_vector_push(&graph.special_branches, &(struct ggit_special_branch){ _strdup("master"),   regex_compile("^master$"),   0, { [0] = { 0x7E, 0xD3, 0x21 }, [1] = {} } });
-    ggit_vector_push(&graph.special_branches, &(struct ggit_special_branch){ _strdup("hotfix/"),  regex_compile("^hotfix/"),  -1, { [0] = { 0xE6, 0x00, 0x00 }, [1] = {} } });
-    ggit_vector_push(&graph.special_branches, &(struct ggit_special_branch){ _strdup("release/"), regex_compile("^release/"), -1, { [0] = { 0x00, 0x68, 0xDE }, [1] = {} } });
-    ggit_vector_push(&graph.special_branches, &(struct ggit_special_branch){ _strdup("bugfix/"),  regex_compile("^bugfix/"),  +1, { [0] = { 0xE6, 0x96, 0x17 }, [1] = {} } });
-    ggit_vector_push(&graph.special_branches, &(struct ggit_special_branch){ _strdup("develop/"), regex_compile("^develop/"), +1, { [0] = { 0xB8, 0x16, 0xD9 }, [1] = {} } });
-    ggit_vector_push(&graph.special_branches, &(struct ggit_special_branch){ _strdup("sprint/"),  regex_compile("^sprint/"),  +1, { [0] = { 0xB8, 0x16, 0xD9 }, [1] = {} } });
-    ggit_vector_push(&graph.special_branches, &(struct ggit_special_branch){ _strdup("feature/"), regex_compile("^feature/"), +1, { [0] = { 0x34, 0xD3, 0xE5 }, [1] = {} } });
-    ggit_vector_push(&graph.special_branches, &(struct ggit_special_branch){ _strdup(""),         regex_compile(".*"),        +1, { [0] = { 0xCC, 0xCC, 0xCC }, [1] = {} } });
-    // clang-format on
-
-    for (int i = 0; i < graph.special_branches.size; ++i) {
-        ggit_vector_init(
-            &ggit_vector_ref_special_branch(&graph.special_branches, i)->instances,
-            sizeof(char*)
-        );
-        ggit_vector_init(
-            &ggit_vector_ref_special_branch(&graph.special_branches, i)->spans,
-            sizeof(struct ggit_column_span)
-        );
+    /* NOTE(boz): Built-in branches, for when GGIT_BRANCH_CONFIG can't be read. */
+    if (ggit_graph_load_config(&graph, GGIT_BRANCH_CONFIG) != 0) {
+        // clang-format off
+        ggit_special_branch_add(&graph.special_branches, "master",   "^master$",   0, (uint8_t[3]){ 0x7E, 0xD3, 0x21 });
+        ggit_special_branch_add(&graph.special_branches, "hotfix/",  "^hotfix/",  -1, (uint8_t[3]){ 0xE6, 0x00, 0x00 });
+        ggit_special_branch_add(&graph.special_branches, "release/", "^release/", -1, (uint8_t[3]){ 0x00, 0x68, 0xDE });
+        ggit_special_branch_add(&graph.special_branches, "bugfix/",  "^bugfix/",  +1, (uint8_t[3]){ 0xE6, 0x96, 0x17 });
+        ggit_special_branch_add(&graph.special_branches, "develop/", "^develop/", +1, (uint8_t[3]){ 0xB8, 0x16, 0xD9 });
+        ggit_special_branch_add(&graph.special_branches, "sprint/",  "^sprint/",  +1, (uint8_t[3]){ 0xB8, 0x16, 0xD9 });
+        ggit_special_branch_add(&graph.special_branches, "feature/", "^feature/", +1, (uint8_t[3]){ 0x34, 0xD3, 0xE5 });
+        ggit_special_branch_add(&graph.special_branches, "",         ".*",        +1, (uint8_t[3]){ 0xCC, 0xCC, 0xCC });
+        // clang-format on
     }
 
     // ggit_graph_load(&graph, "D:/public/ggit/tests/1");
     // ggit_graph_load(&graph, "D:/public/ggit/tests/2");
     ggit_graph_load(&graph, "D:/public/ggit/tests/3");
+    if (ui.print_memory)
+        ggit_ui_print_memory(&ui, &graph);
     // ggit_graph_load(&graph, "D:/public/ggit/tests/tag-with-multiple-matches");
     // ggit_graph_load(&graph, "C:/Projects/ColumboMonorepo");
     // ggit_graph_load(&graph, "D:/Stuff/work/Columbo");
 
+    /* NOTE(boz):
+        Frames are event-driven. While nothing is dirty, block in
+        SDL_WaitEventTimeout instead of redrawing the same picture.
+        Any event marks the UI dirty, so is an animation that needs another frame.
+    */
+    ui.dirty = true;
     bool running = true;
     while (running) {
         input.delta_mouse_x = 0;
@@ -1281,10 +2469,12 @@ main(int argc, char** argv)
         for (int i = 0; i < ARRAY_COUNT(input.buttons); ++i) {
             input.buttons[i] %= 2;
         }
-        int a;
 
         SDL_Event event;
-        while (SDL_PollEvent(&event)) {
+        int has_event = ui.dirty ? SDL_PollEvent(&event)
+                                 : SDL_WaitEventTimeout(&event, GGIT_IDLE_WAIT_MS);
+        for (; has_event; has_event = SDL_PollEvent(&event)) {
+            ui.dirty = true;
             switch (event.type) {
                 case SDL_WINDOWEVENT:
                     switch (event.window.event) {
@@ -1306,20 +2496,33 @@ main(int argc, char** argv)
                     break;
                 case SDL_MOUSEWHEEL:
                     if (input.is_ctrl_down) {
-                        scale += 0.1f * (-1.0f + 2.0f * (event.wheel.y > 0))
-                                 * (event.wheel.y != 0);
-                        scale = max(scale, 0.1f);
-
-                        ui.item_w = original_ui.item_w * scale;
-                        ui.item_h = original_ui.item_h * scale;
-                        ui.border = original_ui.border;
-                        ui.margin_x = original_ui.margin_x;
-                        ui.margin_y = original_ui.margin_y;
+                        int const direction = (event.wheel.y > 0) - (event.wheel.y < 0);
+                        /* NOTE(boz):
+                            At the smallest scale a row is a single pixel, zooming
+                            out further packs 2, 4, 8... rows into every pixel.
+                        */
+                        if (direction < 0 && scale < 0.15f) {
+                            ui.row_shift = min(ui.row_shift + 1, GGIT_MAX_ROW_SHIFT);
+                        } else if (direction > 0 && ui.row_shift > 0) {
+                            ui.row_shift -= 1;
+                        } else {
+                            scale += 0.1f * direction;
+                            scale = max(scale, 0.1f);
+                        }
+
+                        ui.item_w = max(1, (int)(original_ui.item_w * scale));
+                        ui.item_h = max(1, (int)(original_ui.item_h * scale));
+                        ui.border = (int)(original_ui.border * scale + 0.5f);
+                        ui.margin_x = (int)(original_ui.margin_x * scale + 0.5f);
+                        ui.margin_y = (int)(original_ui.margin_y * scale + 0.5f);
                     } else {
                         int delta = (-1 + 2 * (event.wheel.y > 0))
                                     * (event.wheel.y != 0);
                         ui.graph_y += delta
-                                      * (ui.item_h + ui.border * 2 + ui.margin_y * 2);
+                                      * max(
+                                          GGIT_SCROLL_MIN_PX,
+                                          ui.item_h + ui.border * 2 + ui.margin_y * 2
+                                      );
                     }
 
                     break;
@@ -1327,29 +2530,129 @@ main(int argc, char** argv)
                     if (event.key.keysym.scancode == SDL_SCANCODE_LCTRL) {
                         input.is_ctrl_down = false;
                     }
+                    if (event.key.keysym.scancode == SDL_SCANCODE_LSHIFT
+                        || event.key.keysym.scancode == SDL_SCANCODE_RSHIFT) {
+                        input.is_shift_down = false;
+                    }
+                    break;
+                case SDL_TEXTINPUT:
+                    if (ui.prompt.kind != ggit_prompt_none)
+                        ggit_ui_prompt_type(&ui, &graph, event.text.text);
                     break;
                 case SDL_KEYDOWN:
+                    if (ui.prompt.kind != ggit_prompt_none) {
+                        switch (event.key.keysym.scancode) {
+                            case SDL_SCANCODE_RETURN:
+                            case SDL_SCANCODE_KP_ENTER:
+                                ggit_ui_prompt_submit(
+                                    &ui,
+                                    &graph,
+                                    event.key.keysym.mod & KMOD_SHIFT
+                                );
+                                break;
+                            case SDL_SCANCODE_ESCAPE: ggit_ui_prompt_close(&ui); break;
+                            case SDL_SCANCODE_BACKSPACE:
+                                ggit_ui_prompt_backspace(&ui, &graph);
+                                break;
+                            default: break;
+                        }
+                    }
                     if (event.key.keysym.scancode == SDL_SCANCODE_LCTRL) {
                         input.is_ctrl_down = true;
                     }
+                    if (event.key.keysym.scancode == SDL_SCANCODE_LSHIFT
+                        || event.key.keysym.scancode == SDL_SCANCODE_RSHIFT) {
+                        input.is_shift_down = true;
+                    }
+                    if (event.key.keysym.scancode == SDL_SCANCODE_F2) {
+                        ggit_ui_prompt_open(&ui, ggit_prompt_filter);
+                    }
+                    if (event.key.keysym.scancode == SDL_SCANCODE_F
+                        && (event.key.keysym.mod & KMOD_CTRL)) {
+                        ggit_ui_prompt_open(&ui, ggit_prompt_search);
+                    }
+                    if (event.key.keysym.scancode == SDL_SCANCODE_G
+                        && (event.key.keysym.mod & KMOD_CTRL)) {
+                        ggit_ui_prompt_open(&ui, ggit_prompt_jump);
+                    }
+                    if (event.key.keysym.scancode == SDL_SCANCODE_D
+                        && (event.key.keysym.mod & KMOD_CTRL)) {
+                        ggit_ui_toggle_descendants(&ui);
+                    }
+                    if (ui.prompt.kind == ggit_prompt_none) {
+                        if (event.key.keysym.scancode == SDL_SCANCODE_UP)
+                            ggit_ui_select_step(&ui, &graph, -1);
+                        if (event.key.keysym.scancode == SDL_SCANCODE_DOWN)
+                            ggit_ui_select_step(&ui, &graph, +1);
+                    }
+                    if (event.key.keysym.scancode == SDL_SCANCODE_F3) {
+                        ggit_profiler.visible = !ggit_profiler.visible;
+                    }
+                    if (event.key.keysym.scancode == SDL_SCANCODE_F4) {
+                        ggit_profile_dump_csv("ggit-profile.csv");
+                    }
+                    if (event.key.keysym.scancode == SDL_SCANCODE_F7) {
+                        ggit_ui_toggle_viewport_compression(&ui);
+                    }
                     if (event.key.keysym.scancode == SDL_SCANCODE_F5) {
-                        ggit_graph_load(&graph, "D:/public/ggit/tests/3");
+                        ggit_ui_reload(&ui, &graph, "D:/public/ggit/tests/3");
                     }
                     if (event.key.keysym.scancode == SDL_SCANCODE_F6) {
-                        ggit_graph_load(&graph, "D:/Stuff/work/Columbo");
+                        ggit_ui_reload(&ui, &graph, "D:/Stuff/work/Columbo");
+                    }
+                    if (event.key.keysym.scancode == SDL_SCANCODE_F8) {
+                        ggit_ui_toggle_folds(&ui);
+                    }
+                    if (event.key.keysym.scancode == SDL_SCANCODE_F9) {
+                        ggit_ui_reload_branches(&graph);
                     }
                     break;
             }
         }
 
+        if (!ui.dirty)
+            continue;
+        if (SDL_GetWindowFlags(window) & SDL_WINDOW_MINIMIZED) {
+            ui.dirty = false;
+            continue;
+        }
+        ui.dirty = false;
+
+        ggit_profile_frame_begin();
+        ggit_ui_view__sync(&ui, &graph);
+        ggit_ui_search__sync(&ui, &graph);
         ggit_ui_input(&ui, &input, &graph);
         SDL_SetRenderDrawColor(renderer, 245, 245, 245, 255);
         SDL_RenderClear(renderer);
+
+        ggit_profile_pass_begin(ggit_profile_pass_overlay);
         ggit_ui_draw_overlay(&ui, &input, &graph);
+        ggit_profile_pass_end(ggit_profile_pass_overlay);
+
         ggit_ui_draw_graph(&ui, &input, &graph);
+        ggit_ui_draw_prompt(&ui);
+
+        if (ggit_profiler.visible) {
+            ggit_profile_pass_begin(ggit_profile_pass_hud);
+            ggit_ui_draw_profiler(&ui, &graph);
+            ggit_profile_pass_end(ggit_profile_pass_hud);
+        }
+
+        ggit_profile_pass_begin(ggit_profile_pass_present);
         SDL_RenderPresent(renderer);
+        ggit_profile_pass_end(ggit_profile_pass_present);
+
+        struct ggit_memory_report memory;
+        ggit_ui_memory_report(&ui, &graph, &memory);
+        ggit_profile_set_memory(&memory);
+        ggit_profile_frame_end();
     }
 end:;
+    if (ui.print_memory)
+        ggit_ui_print_memory(&ui, &graph);
+    ggit_search_destroy(&ui.search.engine);
+    ggit_ancestry_destroy(&ui.ancestry.engine);
+    ggit_vector_destroy(&ui.ancestry.contains);
     TTF_CloseFont(font);
     return 0;
 }